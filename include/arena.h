@@ -0,0 +1,15 @@
+#include <stddef.h>
+
+#ifndef ARENA_H
+#define ARENA_H
+
+// the strings of one frame of the Debug TUI take a few KiB, so the first chunk
+// is usually the only one
+#define FRAME_ARENA_CHUNK_SIZE (64 * 1024)
+
+void *frame_alloc(size_t size);
+char *frame_str_copy(const char *str);
+void reset_frame_arena();
+void fin_frame_arena();
+
+#endif // ARENA_H
@@ -0,0 +1,32 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef BRANCH_PRED_H
+#define BRANCH_PRED_H
+
+#define DEFAULT_PREDICTOR_BITS 10
+#define MAX_PREDICTOR_BITS 24
+#define NUM_MISPREDICTED_BRANCHES 10
+
+typedef enum { PRED_STATIC, PRED_1BIT, PRED_2BIT, PRED_GSHARE } Predictor;
+
+typedef enum {
+  BRANCH_EXECUTED,
+  BRANCH_TAKEN,
+  BRANCH_MISPREDICTED,
+} Branch_Count;
+
+extern bool branch_pred_active;
+extern Predictor predictor;
+extern uint8_t predictor_bits;
+
+extern uint64_t num_branches;
+extern uint64_t num_mispredictions;
+extern bool last_prediction_correct;
+
+bool parse_branch_pred_config(const char *spec);
+void init_branch_pred();
+bool record_branch(uint32_t pc, int32_t offset, bool taken);
+void print_branch_pred_stats();
+
+#endif // BRANCH_PRED_H
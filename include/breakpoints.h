@@ -0,0 +1,27 @@
+#include "../include/condition.h"
+#include "../include/parse_instrs.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+// 'l', optionally 'i' or 'e' and a line or an address with up to 10 digits
+#define MAX_CHARS_BREAKPOINT 12
+#define NO_ADDR UINT32_MAX
+#define MAX_CONDITIONAL_BREAKPOINTS 16
+
+extern uint32_t num_breakpoints;
+
+void init_breakpoints();
+bool is_breakpoint(uint32_t addr);
+bool toggle_breakpoint(uint32_t addr);
+bool set_conditional_breakpoint(uint32_t addr, Condition *condition);
+bool breakpoint_hits(uint32_t addr);
+void record_line_addr(Program_Type prgrm_type, uint32_t line, uint32_t addr);
+uint32_t addr_of_line(Program_Type prgrm_type, uint32_t line);
+uint32_t line_of_addr(uint32_t addr, Program_Type *prgrm_type);
+const char *path_of_prgrm(Program_Type prgrm_type);
+uint32_t parse_breakpoint_location(const char *str);
+
+#endif // BREAKPOINTS_H
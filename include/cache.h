@@ -0,0 +1,39 @@
+#include "../include/mem_stats.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#define NUM_CACHE_MISS_PCS 10
+
+typedef enum { CACHE_LRU, CACHE_FIFO, CACHE_RANDOM } Cache_Replacement;
+typedef enum { CACHE_WRITE_BACK, CACHE_WRITE_THROUGH } Cache_Write_Policy;
+
+typedef enum {
+  CACHE_HITS,
+  CACHE_MISSES,
+  CACHE_WRITEBACKS,
+  CACHE_WRITE_THROUGHS,
+  NUM_CACHE_COUNTS
+} Cache_Count;
+
+// all sizes in words, each of them a power of two
+typedef struct {
+  uint32_t size;
+  uint32_t assoc;
+  uint32_t line_size;
+  Cache_Replacement replacement;
+  Cache_Write_Policy write_policy;
+} Cache_Config;
+
+extern bool cache_active;
+extern Cache_Config cache_config;
+extern uint64_t cache_region_counts[NUM_MEM_TYPES][NUM_CACHE_COUNTS];
+
+bool parse_cache_config(const char *spec);
+void init_cache();
+bool cache_access(uint32_t addr, bool is_write);
+void print_cache_stats();
+
+#endif // CACHE_H
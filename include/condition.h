@@ -0,0 +1,42 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CONDITION_H
+#define CONDITION_H
+
+#define MAX_CONDITION_CODE 64
+#define MAX_CONDITION_STACK 16
+#define MAX_CHARS_CONDITION 60
+
+typedef enum {
+  COND_CONST, // followed by a 32 bit value
+  COND_REG,   // followed by the register
+  COND_MEM,
+  COND_NEG,
+  COND_NOT,
+  COND_ADD,
+  COND_SUB,
+  COND_MUL,
+  COND_EQ,
+  COND_NE,
+  COND_LT,
+  COND_LE,
+  COND_GT,
+  COND_GE,
+  COND_AND,
+  COND_OR,
+  COND_END,
+} Condition_Op;
+
+// compiled once from the text of the user into the bytecode of a stack
+// machine, so a check only runs over a few bytes
+typedef struct {
+  uint8_t code[MAX_CONDITION_CODE];
+  uint8_t len;
+} Condition;
+
+bool compile_condition(const char *str, Condition *condition);
+int32_t eval_expression(const Condition *condition);
+bool eval_condition(const Condition *condition);
+
+#endif // CONDITION_H
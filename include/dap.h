@@ -0,0 +1,36 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef DAP_H
+#define DAP_H
+
+// the RETI has only one thread of execution
+#define DAP_THREAD_ID 1
+#define MAX_LEN_DAP_HEADER 128
+#define MAX_DAP_SOURCE_BREAKPOINTS 256
+#define MAX_DAP_MEM_CELLS 4096
+#define MAX_DAP_DISASM_INSTRS 4096
+#define MAX_LEN_DAP_OUTPUT 255
+
+typedef enum {
+  DAP_REGISTERS_SCOPE = 1,
+  DAP_UART_SCOPE,
+  DAP_ISR_SCOPE,
+} Dap_Scope;
+
+extern bool dap_active;
+// set by the thread that reads the requests, the interpreter only has to
+// look at it once per instruction
+extern atomic_bool dap_requests_pending;
+
+void init_dap();
+void evaluate_dap_requests();
+bool handle_dap_requests_while_running();
+void read_dap_input(char *input, const char *message, uint8_t max_num_digits);
+bool dap_steps_into_isr();
+void send_dap_output(const char *category, const char *output);
+void dap_watchpoint_hit(const char *message);
+void fin_dap();
+
+#endif // DAP_H
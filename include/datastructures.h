@@ -14,4 +14,21 @@ void heapify_down(uint8_t idx, uint8_t heap[], uint8_t prio_map[]);
 
 uint8_t pop_highest_prio(uint8_t heap[], uint8_t prio_map[]);
 
+#define PC_MAP_NUM_COUNTS 4
+#define PC_MAP_INITIAL_CAPACITY 1024
+
+// open addressing hash map from an address to a few counters, used for
+// statistics per instruction
+typedef struct {
+  uint32_t *keys;
+  bool *used;
+  uint64_t (*counts)[PC_MAP_NUM_COUNTS];
+  uint32_t capacity;
+  uint32_t size;
+} Pc_Map;
+
+void init_pc_map(Pc_Map *map);
+uint64_t *pc_map_counts(Pc_Map *map, uint32_t pc);
+uint32_t pc_map_sorted_keys(Pc_Map *map, uint8_t count_idx, uint32_t **keys);
+
 #endif // DATASTRUCTURES_H
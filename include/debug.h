@@ -1,5 +1,6 @@
 #include "../include/assemble.h"
 #include "../include/input_output.h"
+#include "../include/live_view.h"
 #include "../include/tui.h"
 #include <stdio.h>
 
@@ -23,6 +24,9 @@ typedef enum {
   CANCEL = 0b11111111,
 } BoxIdentifier;
 
+#define NUM_DUMPABLE_BOXES (SRAM_S_BOX + 1)
+#define ALL_BOXES ((1 << NUM_DUMPABLE_BOXES) - 1)
+
 extern char *watchobject_addr;
 
 extern const Menu_Entry box_entries[];
@@ -51,6 +55,7 @@ extern Register sram_watchobject_stack;
 
 char *read_stdin();
 void process_and_print_array(uint32_t *array, size_t length);
+char *write_assembly_str(char *instr_str, Instruction *instr);
 char *assembly_to_str(Instruction *instr);
 char *mem_value_to_str(int32_t mem_content, bool is_unsigned);
 
@@ -66,6 +71,10 @@ void print_array_with_idcs_from_to(MemType mem_type, uint64_t start,
 void print_file_with_idcs(MemType mem_type, uint64_t start, uint64_t end,
                           bool are_unsigned, bool are_instrs);
 bool draw_tui(void);
+void draw_live_frame(const Live_Snapshot *snapshot);
+bool dump_boxes(const char *identifier);
+void step_back_to_breakpoint();
+void set_registers(const uint32_t *values);
 void evaluate_keyboard_input(void);
 void handle_heading(bool legacy_debug_tui, bool simple_debug_tui, Box *box,
                     char *format_str, const char *watchobject,
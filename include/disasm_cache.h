@@ -0,0 +1,30 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef DISASM_CACHE_H
+#define DISASM_CACHE_H
+
+// direct mapped, enough for the code shown by all boxes of a big terminal
+#define DISASM_CACHE_SIZE 2048
+#define ASSEMBLY_STR_SIZE 39 // STOREIN ACC IN2 22bit\0
+
+typedef enum {
+  DISASM_WORD = 0b001,
+  DISASM_DECIMAL = 0b010,
+  DISASM_BINARY = 0b100,
+} Disasm_Valid_Flag;
+
+typedef struct {
+  uint32_t addr;
+  uint32_t machine_instr;
+  uint8_t valid;
+  char decimal_str[ASSEMBLY_STR_SIZE];
+  char binary_str[ASSEMBLY_STR_SIZE];
+} Disasm_Entry;
+
+bool cached_machine_instr(uint32_t addr, uint32_t *machine_instr);
+const char *cached_assembly_str(uint32_t addr, uint32_t machine_instr);
+void invalidate_disasm(uint32_t addr);
+void clear_disasm_cache();
+
+#endif // DISASM_CACHE_H
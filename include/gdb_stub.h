@@ -0,0 +1,31 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef GDB_STUB_H
+#define GDB_STUB_H
+
+// the maximum packet size that is announced to GDB
+#define GDB_PACKET_SIZE 4096
+// every byte needs 2 hex digits, the bytes can start in the middle of a cell
+#define MAX_GDB_MEM_BYTES (GDB_PACKET_SIZE / 2 - 1)
+#define MAX_GDB_MEM_CELLS (MAX_GDB_MEM_BYTES / 4 + 2)
+// the last byte of the cell at the highest address
+#define MAX_GDB_BYTE_ADDR (4 * (uint64_t)UINT32_MAX + 3)
+#define GDB_TARGET_XML_SIZE 1024
+// instructions between two looks for a Ctrl-C of GDB while running
+#define GDB_POLL_INTERVAL 4096
+#define GDB_INTERRUPT_CHAR 0x03
+
+#define GDB_SIGINT 2
+#define GDB_SIGTRAP 5
+
+extern bool gdb_active;
+// a port on localhost or the path of a Unix socket
+extern char *gdb_address;
+
+void init_gdb_stub();
+void evaluate_gdb_requests();
+bool gdb_interrupt_requested();
+void fin_gdb_stub();
+
+#endif // GDB_STUB_H
@@ -20,6 +20,12 @@ typedef struct {
 
 #define MAX_CHARS_WATCHOBJECT 20
 
+extern bool debug_script_active;
+extern char *debug_script_path;
+
+void init_debug_script();
+int get_command_char();
+void clear_prompt_line();
 void display_input_message(char *input, const char *message,
                            uint8_t max_num_digits);
 void display_error_notification(const char *message);
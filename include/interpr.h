@@ -7,9 +7,15 @@
 #define MAX_DIGITS_ADDR_DEC 10
 
 extern uint8_t current_isr;
+// address of the instruction that is currently being executed
+extern uint32_t instr_pc;
+// instructions executed since the start, the clock of record and replay
+extern uint64_t num_executed_instrs;
+extern uint64_t num_isr_returns;
 
 #define visibility_condition debug_mode && breakpoint_encountered && isr_finished && (!isr_active || step_into_activated)
 
+bool jump_condition_holds(uint8_t op, int32_t acc);
 void interpr_instr(Instruction *assembly_instr);
 void interpr_prgrm();
 void setup_interrupt(uint32_t ivt_table_addr) ;
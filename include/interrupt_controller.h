@@ -20,6 +20,7 @@ typedef enum {
 extern uint8_t device_to_isr[NUM_DEVICES];
 extern uint8_t *isr_to_prio;
 
+extern uint8_t isr_priority_stack[MAX_STACK_SIZE];
 extern int8_t stack_top;
 
 extern uint8_t isr_heap[];
@@ -0,0 +1,75 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef JSON_H
+#define JSON_H
+
+// the requests of the protocol are flat objects of a few short members
+#define MAX_JSON_MEMBERS 8
+#define MAX_LEN_JSON_KEY 15
+#define MAX_LEN_JSON_STR 63
+// the messages of the Debug Adapter Protocol are nested
+#define MAX_JSON_DEPTH 32
+
+typedef enum {
+  JSON_NULL,
+  JSON_BOOL,
+  JSON_NUMBER,
+  JSON_STRING,
+  JSON_ARRAY,
+  JSON_OBJECT,
+} Json_Type;
+
+typedef struct {
+  char key[MAX_LEN_JSON_KEY + 1];
+  Json_Type type;
+  int64_t num; // also the value of booleans
+  char str[MAX_LEN_JSON_STR + 1];
+} Json_Member;
+
+typedef struct {
+  Json_Member members[MAX_JSON_MEMBERS];
+  uint8_t num_members;
+} Json_Object;
+
+typedef struct Json_Value {
+  Json_Type type;
+  int64_t num; // also the value of booleans, fractions are cut off
+  char *str;
+  char *key; // if it is the member of an object
+  struct Json_Value *children; // the elements or members
+  uint32_t num_children;
+} Json_Value;
+
+typedef struct {
+  char *data;
+  size_t len;
+  size_t size;
+} Json_Writer;
+
+bool parse_json_object(const char *str, Json_Object *object);
+const Json_Member *json_member(const Json_Object *object, const char *key);
+const char *json_get_str(const Json_Object *object, const char *key);
+bool json_get_num(const Json_Object *object, const char *key, int64_t *value);
+
+Json_Value *parse_json(const char *str);
+const Json_Value *json_get(const Json_Value *object, const char *key);
+const char *json_value_str(const Json_Value *value);
+bool json_value_num(const Json_Value *value, int64_t *num);
+void free_json(Json_Value *value);
+
+// a key of NULL writes a value into the array or object that is open
+void json_reset(Json_Writer *writer);
+void json_begin_object(Json_Writer *writer, const char *key);
+void json_end_object(Json_Writer *writer);
+void json_begin_array(Json_Writer *writer, const char *key);
+void json_end_array(Json_Writer *writer);
+void json_int(Json_Writer *writer, const char *key, int64_t value);
+void json_uint(Json_Writer *writer, const char *key, uint64_t value);
+void json_bool(Json_Writer *writer, const char *key, bool value);
+void json_str(Json_Writer *writer, const char *key, const char *value);
+void json_null(Json_Writer *writer, const char *key);
+void fin_json_writer(Json_Writer *writer);
+
+#endif // JSON_H
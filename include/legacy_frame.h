@@ -0,0 +1,17 @@
+#include <stdarg.h>
+#include <stddef.h>
+
+#ifndef LEGACY_FRAME_H
+#define LEGACY_FRAME_H
+
+typedef struct {
+  char *data;
+  size_t len;
+  size_t size;
+} Frame_Buffer;
+
+void legacy_vprint(const char *format, va_list args);
+void legacy_print(const char *format, ...);
+void write_legacy_frame();
+
+#endif // LEGACY_FRAME_H
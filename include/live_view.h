@@ -0,0 +1,41 @@
+#include "../include/reti.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef LIVE_VIEW_H
+#define LIVE_VIEW_H
+
+#define LIVE_VIEW_FRAME_MS 33
+// a box is at most 255 lines high and shows its watchobject in the middle,
+// shifted by at most half of its height at the ends of the SRAM
+#define LIVE_VIEW_WINDOW_RADIUS UINT8_MAX
+#define NUM_SRAM_WINDOWS 3
+
+typedef enum {
+  LIVE_VIEW_FRAME_REQUESTED = 0b01,
+  LIVE_VIEW_PAUSE = 0b10,
+} Live_View_Event;
+
+typedef struct {
+  uint64_t start;
+  uint16_t len;
+  uint32_t cells[2 * LIVE_VIEW_WINDOW_RADIUS + 1];
+} Sram_Window;
+
+// everything a frame of the Debug TUI reads that the emulator changes while
+// it runs
+typedef struct {
+  uint32_t regs[NUM_REGISTERS];
+  uint8_t uart[NUM_UART_ADDRESSES];
+  uint64_t num_executed_instrs;
+  Sram_Window sram_windows[NUM_SRAM_WINDOWS];
+} Live_Snapshot;
+
+extern bool live_view_active;
+
+void start_live_view();
+void check_live_view();
+void stop_live_view();
+uint32_t snapshot_sram_cell(const Live_Snapshot *snapshot, uint64_t idx);
+
+#endif // LIVE_VIEW_H
@@ -0,0 +1,24 @@
+#include "../include/debug.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef MEM_STATS_H
+#define MEM_STATS_H
+
+#define NUM_MEM_TYPES (SRAM_S + 1)
+#define NUM_HOT_PAGES 10
+#define NUM_HEAT_LEVELS 4
+
+extern bool mem_stats_active;
+extern bool heatmap_active;
+
+extern const char *mem_type_to_name[];
+
+MemType mem_type_of_addr(uint32_t addr);
+
+void init_mem_stats();
+void record_mem_access(uint32_t addr, bool is_write);
+uint8_t heat_level_of_sram_cell(uint64_t idx);
+void print_mem_stats();
+
+#endif // MEM_STATS_H
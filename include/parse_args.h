@@ -16,6 +16,7 @@ extern uint8_t radius;
 extern uint8_t max_waiting_instrs;
 extern bool verbose;
 extern bool legacy_debug_tui;
+extern bool legacy_diff_active;
 extern bool ds_vals_unsigned;
 extern bool ds_address_extension;
 
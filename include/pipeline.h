@@ -0,0 +1,38 @@
+#include "../include/assemble.h"
+#include "../include/reti.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+// cycles until the PC is known after a jump in ID, a PC write in EX and a PC
+// write with a value from memory in MEM
+#define JUMP_PENALTY 1
+#define EX_PC_WRITE_PENALTY 2
+#define MEM_PC_WRITE_PENALTY 3
+
+// one run of the pipeline, the model runs once with and once without
+// forwarding to show what forwarding saves
+typedef struct {
+  uint64_t next_ex;
+  uint64_t last_ex;
+  uint64_t reg_ready[NUM_REGISTERS];
+  uint64_t reg_producer_ex[NUM_REGISTERS];
+  uint64_t data_stalls;
+  uint64_t control_stalls;
+  uint64_t forwards;
+} Pipeline_Timeline;
+
+extern bool pipeline_active;
+extern char *pipeline_report_path;
+
+extern uint64_t pipeline_instrs;
+extern Pipeline_Timeline with_forwarding, without_forwarding;
+
+void init_pipeline();
+void pipeline_instr(uint32_t pc, Instruction *instr);
+uint64_t pipeline_cycles(Pipeline_Timeline *timeline);
+void print_pipeline_stats();
+
+#endif // PIPELINE_H
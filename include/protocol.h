@@ -0,0 +1,20 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#define MAX_LEN_PROTOCOL_LINE 1024
+// a view of the memory is refreshed with one request
+#define MAX_PROTOCOL_MEM_CELLS 4096
+#define MAX_LEN_PROTOCOL_MESSAGE 255
+
+extern bool protocol_active;
+
+void evaluate_protocol_requests();
+void read_protocol_input(char *input, const char *message,
+                         uint8_t max_num_digits);
+void send_protocol_message(const char *event, const char *message);
+void fin_protocol();
+
+#endif // PROTOCOL_H
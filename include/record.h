@@ -0,0 +1,32 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#define RECORD_MAGIC "RETIREC"
+#define RECORD_VERSION 1
+
+typedef enum { RECORD_RAND, RECORD_INPUT, RECORD_KEYPRESS } Record_Type;
+
+typedef struct {
+  uint64_t instr_idx;
+  Record_Type type;
+  uint32_t value;
+} Record_Event;
+
+extern bool record_active;
+extern bool replay_active;
+extern char *record_path;
+extern char *replay_path;
+extern uint64_t seed;
+extern uint64_t prng_state;
+
+void init_record();
+uint32_t machine_rand();
+uint32_t recorded_user_input();
+void record_keypress();
+void replay_keypresses();
+void fin_record();
+
+#endif // RECORD_H
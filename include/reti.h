@@ -27,6 +27,8 @@ extern FILE *sram;
 void load_adjusted_eprom_prgrm();
 
 uint32_t read_file(FILE *dev, uint64_t address);
+void read_file_range(FILE *dev, uint64_t address, uint32_t *buffer,
+                     uint32_t num_cells);
 void write_file(FILE *dev, uint64_t address, uint32_t buffer);
 
 uint32_t read_array(void *stor, uint16_t addr, bool is_uart);
@@ -34,7 +36,10 @@ void write_array(void *stor, uint16_t addr, uint32_t buffer, bool is_uart);
 
 uint32_t read_storage_fill(uint32_t addr);
 uint32_t read_storage_sram_constant_fill(uint32_t addr) ;
+uint32_t read_storage_raw(uint32_t addr);
 uint32_t read_storage(uint32_t addr);
+bool read_storage_range(uint32_t addr, uint32_t count, uint32_t *values);
+uint32_t fetch_instr(uint32_t addr);
 void write_storage_ds_fill(uint64_t addr, uint32_t buffer);
 void write_storage(uint32_t addr, uint32_t buffer);
 
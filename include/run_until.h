@@ -0,0 +1,24 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef RUN_UNTIL_H
+#define RUN_UNTIL_H
+
+// n, p or r, a space and a number with up to 10 digits or a register
+#define MAX_CHARS_RUN_UNTIL 12
+
+typedef enum {
+  UNTIL_STEPS,
+  UNTIL_PC,
+  UNTIL_REG_CHANGE,
+  UNTIL_UART_OUTPUT,
+  UNTIL_ISR_RETURN,
+} Until_Kind;
+
+extern bool run_until_active;
+
+bool parse_num_steps(const char *str);
+bool parse_run_until(const char *str);
+void check_run_until();
+
+#endif // RUN_UNTIL_H
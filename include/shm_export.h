@@ -0,0 +1,44 @@
+#include "../include/interrupt_controller.h"
+#include "../include/reti.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef SHM_EXPORT_H
+#define SHM_EXPORT_H
+
+#define SHM_EXPORT_MAGIC 0x52455449 // "RETI"
+#define SHM_EXPORT_VERSION 1
+// instructions between two updates while running, a viewer samples far less
+// often
+#define SHM_UPDATE_INTERVAL 1024
+
+// the layout of the shared memory. A reader copies the state and keeps the
+// copy only if seq was even before and unchanged after copying, an odd seq
+// means that the emulator is writing
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  _Atomic uint64_t seq;
+  uint32_t regs[NUM_REGISTERS];
+  uint8_t uart[NUM_UART_ADDRESSES];
+  uint8_t isr_priority_stack[MAX_STACK_SIZE];
+  int8_t stack_top; // -1 if no interrupt service routine is active
+  uint8_t current_isr;
+  bool isr_active;
+  bool finished;
+  uint64_t num_executed_instrs;
+  uint64_t num_isr_returns;
+  uint64_t cycles; // only counted with --timing
+} Shm_State;
+
+extern bool shm_export_active;
+// the name of the POSIX shared memory object, e.g. /reti
+extern char *shm_export_name;
+
+void init_shm_export();
+void publish_shm_state();
+void check_shm_export();
+void fin_shm_export();
+
+#endif // SHM_EXPORT_H
@@ -0,0 +1,45 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#define SNAPSHOT_MAGIC "RETISNAP"
+#define SNAPSHOT_MAGIC_LEN 8
+#define SNAPSHOT_VERSION 2
+// written in the byte order of the machine, so that a snapshot from a
+// machine with another byte order gets rejected instead of misread
+#define SNAPSHOT_BYTE_ORDER_MARK 0x01020304
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  size_t capacity;
+  size_t pos; // read position when restoring
+  // the SRAM is left out, e.g. because copy-on-write pages take care of it
+  bool without_sram;
+} Snapshot;
+
+extern char *save_snapshot_path;
+extern char *load_snapshot_path;
+
+extern bool restart_snapshot_active;
+extern uint8_t *restart_dirty_pages;
+extern uint32_t restart_tracked_cells;
+
+void snapshot_put(Snapshot *snapshot, const void *value, size_t len);
+bool snapshot_get(Snapshot *snapshot, void *value, size_t len);
+
+void take_snapshot(Snapshot *snapshot);
+bool restore_snapshot(Snapshot *snapshot);
+void free_snapshot(Snapshot *snapshot);
+
+void save_snapshot(const char *path);
+void load_snapshot(const char *path);
+
+void init_restart_snapshot();
+void save_page_before_write(uint32_t page);
+void restart_from_snapshot();
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,46 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef TIMING_H
+#define TIMING_H
+
+typedef enum {
+  TIMING_COMPUTE_I,
+  TIMING_COMPUTE_R,
+  TIMING_COMPUTE_M,
+  TIMING_LOAD,
+  TIMING_LOADI,
+  TIMING_STORE,
+  TIMING_MOVE,
+  TIMING_NOP,
+  TIMING_INT,
+  TIMING_RTI,
+  TIMING_JUMP,
+  NUM_INSTR_CLASSES,
+  // latencies per memory access, they are added to the instruction doing it
+  TIMING_EPROM = NUM_INSTR_CLASSES,
+  TIMING_UART,
+  TIMING_SRAM,
+  TIMING_CACHE_HIT,
+  // penalty of a conditional jump that --branch-pred got wrong
+  TIMING_MISPREDICT,
+  NUM_LATENCIES
+} Latency;
+
+extern bool timing_active;
+extern char *timing_path;
+
+extern uint32_t latencies[NUM_LATENCIES];
+extern uint64_t cycles;
+extern uint32_t instr_cycles;
+
+void init_timing();
+Latency instr_class_of_op(uint8_t op);
+void timing_mem_access(uint32_t addr, bool cache_hit);
+void timing_penalty(uint32_t penalty);
+void timing_instr_begin();
+void timing_instr_end(uint8_t op);
+uint32_t elapsed_ticks();
+void print_timing_stats();
+
+#endif // TIMING_H
@@ -0,0 +1,63 @@
+#include "../include/reti.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_MAGIC "RETITRC"
+#define TRACE_MAGIC_LEN 7
+#define TRACE_VERSION 1
+#define TRACE_BUFFER_SIZE (1 << 20)
+#define MAX_TRACE_MEM_WRITES 8
+// flags + pc + instr + reg mask + 7 regs + write count + writes, each value
+// at most 5 bytes when varint encoded
+#define MAX_TRACE_RECORD_SIZE                                                  \
+  (1 + 5 + 4 + 1 + 5 * (NUM_REGISTERS - 1) + 1 + 10 * MAX_TRACE_MEM_WRITES)
+
+typedef enum {
+  TRACE_REGS_CHANGED = 0b001,
+  TRACE_MEM_WRITTEN = 0b010,
+  TRACE_PC_SEQUENTIAL = 0b100,
+} Trace_Flag;
+
+typedef enum { TRACE_HEADER_DELTA = 0b1 } Trace_Header_Flag;
+
+typedef struct {
+  uint32_t addr;
+  uint32_t value;
+} Trace_Mem_Write;
+
+typedef struct {
+  uint32_t pc;
+  uint32_t machine_instr;
+  uint8_t changed_regs; // bit i set means register i changed, PC excluded
+  uint32_t regs[NUM_REGISTERS];
+  uint8_t num_mem_writes;
+  Trace_Mem_Write mem_writes[MAX_TRACE_MEM_WRITES];
+} Trace_Record;
+
+typedef struct {
+  FILE *file;
+  bool delta;
+  uint32_t prev_pc;
+  uint32_t prev_mem_addr;
+  uint32_t regs[NUM_REGISTERS];
+} Trace_Reader;
+
+extern bool trace_active;
+extern bool trace_delta;
+extern char *trace_path;
+
+void init_trace();
+void trace_instr_begin(uint32_t pc, uint32_t machine_instr);
+void trace_mem_write(uint32_t addr, uint32_t value);
+void trace_instr_end();
+void fin_trace();
+
+bool open_trace_reader(Trace_Reader *reader, const char *path);
+bool read_trace_record(Trace_Reader *reader, Trace_Record *record);
+void close_trace_reader(Trace_Reader *reader);
+
+#endif // TRACE_H
@@ -2,18 +2,46 @@
 #define TUI_H
 
 #include <ncurses.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
 
+// the wait for a command of the TUI looks for a resize of the terminal this
+// often
+#define TUI_RESIZE_POLL_MS 100
+
+typedef enum {
+  ROW_VALID = 0b0001,
+  ROW_INSTR = 0b0010,
+  ROW_UNSIGNED = 0b0100,
+  ROW_MARKED = 0b1000,
+} Row_Flag;
+
+#define ROW_HEAT_SHIFT 4
+
+// everything a rendered row of a box depends on, if it didn't change since
+// the last frame, the row can stay on the screen as it is
+typedef struct {
+  uint64_t idx;
+  uint32_t content;
+  uint8_t regs_mask; // bit i set means register i points to the cell
+  uint8_t flags;     // Row_Flags and the heat level in the upper bits
+  uint8_t num_lines;
+} Row_Key;
+
 typedef struct {
   char *title;
   uint8_t x, y;
   uint8_t width, height;
   uint8_t line, col;
   WINDOW *win;
+  Row_Key *rows; // indexed by the line the row starts on
+  uint8_t num_used_lines;
+  bool needs_erase;
 } Box;
 
 extern uint16_t term_width, term_height;
+extern volatile sig_atomic_t term_resized;
 
 extern Box regs_box;
 extern Box eprom_box;
@@ -34,8 +62,12 @@ void fin_tui();
 #define HEIGHT_REGS_BOX 10
 #define HEIGHT_UART_BOX 11
 
+void prepare_box(Box *box);
+bool skip_unchanged_row(Box *box, const Row_Key *key);
+void remember_row(Box *box, const Row_Key *key, uint8_t first_line);
 void reset_box_line(Box *box);
 void make_unneccessary_spaces_visible(Box *box);
 void update_term_and_box_sizes();
+void update_layout_if_resized();
 
 #endif // TUI_H
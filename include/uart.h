@@ -1,3 +1,4 @@
+#include "../include/snapshot.h"
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -20,6 +21,12 @@ extern uint8_t received_num_idx;
 extern uint8_t sending_waiting_time;
 extern uint8_t receiving_waiting_time;
 
+extern bool sending_finished;
+extern bool receiving_finished;
+extern bool init_finished;
+// completely sent strings and integers
+extern uint64_t num_uart_outputs;
+
 typedef enum { STRING, INTEGER = 4 } DataType;
 
 extern DataType datatype;
@@ -34,5 +41,7 @@ void uart_receive();
 uint32_t get_user_input();
 void reset_uart();
 void init_uart() ;
+void save_uart_state(Snapshot *snapshot);
+bool restore_uart_state(Snapshot *snapshot);
 
 #endif // UART_H
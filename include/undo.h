@@ -0,0 +1,38 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef UNDO_H
+#define UNDO_H
+
+// 16 bytes each, so the log takes 4 MiB
+#define UNDO_LOG_SIZE (1 << 18)
+#define UNDO_CHUNK_SIZE 8
+#define MAX_CHARS_NUM_STEPS 10
+
+typedef enum {
+  UNDO_INSTR_END, // separates the entries of two instructions
+  UNDO_MEM,       // old value of a memory cell
+  UNDO_VAR,       // old bytes of a tracked variable
+  UNDO_UART,      // state of the UART before sending, owns a snapshot
+} Undo_Type;
+
+typedef struct {
+  uint8_t type;
+  uint8_t var;
+  uint8_t len;
+  uint32_t addr; // memory address or offset in the variable
+  uint8_t old[UNDO_CHUNK_SIZE];
+} Undo_Entry;
+
+extern bool undo_active;
+
+void init_undo();
+void clear_undo_log();
+void undo_instr_begin();
+void undo_mem_write(uint32_t addr);
+void undo_uart_send();
+void undo_instr_end();
+bool step_back();
+uint64_t num_undoable_instrs();
+
+#endif // UNDO_H
@@ -20,9 +20,10 @@ char *allocate_and_copy_string(const char *original);
 char *extract_line(const char *current, const char *begin);
 int count_lines(const char *current, const char *begin);
 char *create_heading(char insert_chr, const char *text, int linewidth);
+char *write_bin_str(char *bin_str, int num, int bits);
 char *int_to_bin_str(int num, int bits);
 uint8_t num_digits_for_num(uint64_t num);
-char *num_digits_for_idx_str(uint64_t max_idx);
+uint8_t num_digits_for_idx(uint64_t max_idx);
 char *create_formatted_str(const char *format, va_list args);
 void clear_input_buffer(void);
 
@@ -0,0 +1,35 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef WATCHPOINTS_H
+#define WATCHPOINTS_H
+
+#define MAX_WATCHPOINTS 32
+// kinds, a space and a range of two addresses with up to 10 digits
+#define MAX_CHARS_WATCHPOINT 26
+#define MAX_LEN_WATCHPOINT_HIT 100
+
+typedef enum {
+  WATCH_READ = 0b001,
+  WATCH_WRITE = 0b010,
+  WATCH_CHANGE = 0b100,
+} Watch_Kind;
+
+typedef struct {
+  uint32_t from; // SRAM indices, both inclusive
+  uint32_t to;
+  uint8_t kinds;
+} Watchpoint;
+
+extern uint8_t num_watchpoints;
+extern bool watchpoint_hit;
+extern char watchpoint_hit_msg[MAX_LEN_WATCHPOINT_HIT];
+
+void init_watchpoints();
+bool parse_watchpoint(const char *str, Watchpoint *watchpoint);
+bool toggle_watchpoint(Watchpoint *watchpoint);
+bool is_watched(uint32_t addr);
+void check_watchpoints(uint32_t addr, bool is_write, uint32_t value);
+void show_watchpoint_hit();
+
+#endif // WATCHPOINTS_H
@@ -20,14 +20,24 @@ fi
 
 for test in "${paths[@]}"; do
   ./heading_subheadings.py "heading" "$test" "$1" "="
-  ./bin/reti_emulator_main $(cat ./opts/test_opts.txt) $3 $4 "$test";
+  # a test with a debug script also compares what the debugger printed
+  debug_script="${test%.reti}.debug_script"
+  if [ -f "$debug_script" ]; then
+    ./bin/reti_emulator_main $(cat ./opts/test_opts.txt) -d --debug-script "$debug_script" $3 $4 "$test" > "${test%.reti}.debug_output";
+  else
+    ./bin/reti_emulator_main $(cat ./opts/test_opts.txt) $3 $4 "$test";
+  fi
 
   if [[ $? != 0 ]]; then
     not_running_through+=("$test");
   fi;
 
   diff "${test%.reti}.expected_output" "${test%.reti}.output"
-  if [[ $? != 0 ]]; then
+  passed=$?
+  if [ -f "$debug_script" ]; then
+    diff "${test%.reti}.expected_debug_output" "${test%.reti}.debug_output" || passed=1
+  fi
+  if [[ $passed != 0 ]]; then
     not_passed+=("$test");
   fi
   ((num_tests++));
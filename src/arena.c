@@ -0,0 +1,75 @@
+#include "../include/arena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Arena_Chunk {
+  struct Arena_Chunk *next;
+  size_t capacity;
+  size_t used;
+  char data[];
+} Arena_Chunk;
+
+// the chunks are kept after a reset and reused by the next frame, so after the
+// first frames no heap allocation happens anymore
+static Arena_Chunk *first_chunk = NULL;
+static Arena_Chunk *current_chunk = NULL;
+
+static Arena_Chunk *new_chunk(size_t capacity) {
+  Arena_Chunk *chunk = malloc(sizeof(Arena_Chunk) + capacity);
+  if (!chunk) {
+    fprintf(stderr, "Error: Failed to allocate frame arena\n");
+    exit(EXIT_FAILURE);
+  }
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+void *frame_alloc(size_t size) {
+  size = (size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+  if (!current_chunk) {
+    first_chunk = new_chunk(FRAME_ARENA_CHUNK_SIZE);
+    current_chunk = first_chunk;
+  }
+  while (current_chunk->used + size > current_chunk->capacity) {
+    Arena_Chunk *next = current_chunk->next;
+    if (!next || next->capacity < size) {
+      // too small chunks stay in the list, they are reused after the reset
+      Arena_Chunk *chunk = new_chunk(
+          size > FRAME_ARENA_CHUNK_SIZE ? size : FRAME_ARENA_CHUNK_SIZE);
+      chunk->next = next;
+      current_chunk->next = chunk;
+      next = chunk;
+    }
+    current_chunk = next;
+    current_chunk->used = 0;
+  }
+  void *ptr = current_chunk->data + current_chunk->used;
+  current_chunk->used += size;
+  return ptr;
+}
+
+char *frame_str_copy(const char *str) {
+  char *copy = frame_alloc(strlen(str) + 1);
+  strcpy(copy, str);
+  return copy;
+}
+
+// everything allocated by frame_alloc since the last reset becomes invalid
+void reset_frame_arena() {
+  current_chunk = first_chunk;
+  if (current_chunk) {
+    current_chunk->used = 0;
+  }
+}
+
+void fin_frame_arena() {
+  while (first_chunk) {
+    Arena_Chunk *next = first_chunk->next;
+    free(first_chunk);
+    first_chunk = next;
+  }
+  current_chunk = NULL;
+}
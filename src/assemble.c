@@ -18,7 +18,7 @@ uint8_t isr_of_keypress_interrupt = MAX_VAL_ISR;
 const char *register_code_to_name[] = {
     "PC", "IN1", "IN2",      "ACC",     "SP",       "BAF",
     "CS", "DS",  "INTTIMER", "UARTREC", "UARTSEND", "KEYPRESS"};
-static uint8_t isr_num = 0;
+uint8_t isr_num = 0;
 
 String_to_Mnemonic mnemonic_to_opcode[] = {
     {"ADDI", ADDI},     {"SUBI", SUBI},     {"MULTI", MULTI},
@@ -162,6 +162,10 @@ uint32_t assembly_to_machine(String_Instruction *str_instr) {
   } else if (op == IVTE) {
     machine_instr = 0b10 << 30 | opd1;
     isr_num++;
+    // isr_to_prio always covers the whole IVT, so that snapshots know its
+    // size
+    isr_to_prio = realloc(isr_to_prio, sizeof(uint8_t) * (isr_num));
+    isr_to_prio[isr_num - 1] = 0;
   } else if (op == IVTEDP) {
     machine_instr = 0b10 << 30 | opd1;
     isr_num++;
@@ -0,0 +1,158 @@
+#include "../include/branch_pred.h"
+#include "../include/assemble.h"
+#include "../include/datastructures.h"
+#include "../include/debug.h"
+#include "../include/reti.h"
+#include "../include/timing.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool branch_pred_active = false;
+Predictor predictor = PRED_2BIT;
+uint8_t predictor_bits = DEFAULT_PREDICTOR_BITS;
+
+uint64_t num_branches = 0;
+uint64_t num_mispredictions = 0;
+bool last_prediction_correct = true;
+
+static const char *predictor_to_name[] = {"static", "1bit", "2bit", "gshare"};
+
+// 1 bit predictors only use the values 0 and 1, 2 bit saturating counters
+// predict taken from 2 upwards
+static uint8_t *pattern_table = NULL;
+static uint32_t table_mask;
+static uint32_t global_history = 0;
+
+static Pc_Map branch_counts;
+
+// static|1bit|2bit|gshare[:bits]
+bool parse_branch_pred_config(const char *spec) {
+  const char *colon = strchr(spec, ':');
+  size_t name_len = colon ? (size_t)(colon - spec) : strlen(spec);
+  uint8_t i = 0;
+  while (i <= PRED_GSHARE && (strlen(predictor_to_name[i]) != name_len ||
+                              strncmp(spec, predictor_to_name[i], name_len))) {
+    i++;
+  }
+  if (i > PRED_GSHARE) {
+    return false;
+  }
+
+  uint8_t bits = DEFAULT_PREDICTOR_BITS;
+  if (colon) {
+    char *endptr;
+    long tmp_val = strtol(colon + 1, &endptr, 10);
+    if (i == PRED_STATIC || endptr == colon + 1 || *endptr != '\0' ||
+        tmp_val < 1 || tmp_val > MAX_PREDICTOR_BITS) {
+      return false;
+    }
+    bits = tmp_val;
+  }
+
+  predictor = i;
+  predictor_bits = bits;
+  return true;
+}
+
+void init_branch_pred() {
+  free(pattern_table);
+  pattern_table = NULL;
+  if (predictor != PRED_STATIC) {
+    pattern_table = malloc(1 << predictor_bits);
+    if (!pattern_table) {
+      fprintf(stderr, "Error: Failed to allocate the branch predictor\n");
+      exit(EXIT_FAILURE);
+    }
+    // weakly not taken
+    memset(pattern_table, predictor == PRED_1BIT ? 0 : 1, 1 << predictor_bits);
+  }
+  table_mask = (1 << predictor_bits) - 1;
+  global_history = 0;
+  num_branches = num_mispredictions = 0;
+  init_pc_map(&branch_counts);
+}
+
+// returns whether the branch was predicted correctly
+bool record_branch(uint32_t pc, int32_t offset, bool taken) {
+  bool prediction;
+  uint8_t *entry = NULL;
+  switch (predictor) {
+  case PRED_STATIC:
+    // backward taken, forward not taken, which fits loops
+    prediction = offset < 0;
+    break;
+  case PRED_1BIT:
+    entry = &pattern_table[pc & table_mask];
+    prediction = *entry;
+    *entry = taken;
+    break;
+  case PRED_2BIT:
+  case PRED_GSHARE:
+    entry = &pattern_table[(predictor == PRED_GSHARE ? pc ^ global_history : pc) &
+                           table_mask];
+    prediction = *entry >= 2;
+    if (taken && *entry < 3) {
+      (*entry)++;
+    } else if (!taken && *entry > 0) {
+      (*entry)--;
+    }
+    global_history = ((global_history << 1) | taken) & table_mask;
+    break;
+  }
+
+  uint64_t *counts = pc_map_counts(&branch_counts, pc);
+  counts[BRANCH_EXECUTED]++;
+  counts[BRANCH_TAKEN] += taken;
+  num_branches++;
+  last_prediction_correct = prediction == taken;
+  if (prediction != taken) {
+    counts[BRANCH_MISPREDICTED]++;
+    num_mispredictions++;
+    if (timing_active) {
+      timing_penalty(latencies[TIMING_MISPREDICT]);
+    }
+    return false;
+  }
+  return true;
+}
+
+void print_branch_pred_stats() {
+  if (predictor == PRED_STATIC) {
+    fprintf(stderr, "Branch prediction (static):\n");
+  } else {
+    fprintf(stderr, "Branch prediction (%s, %u bits):\n",
+            predictor_to_name[predictor], predictor_bits);
+  }
+  fprintf(stderr, "  %" PRIu64 " conditional jumps, %" PRIu64 " mispredicted",
+          num_branches, num_mispredictions);
+  if (num_branches > 0) {
+    fprintf(stderr, " (%.2f%%)", 100.0 * num_mispredictions / num_branches);
+  }
+  fprintf(stderr, "\n");
+
+  uint32_t *pcs;
+  uint32_t num_pcs =
+      pc_map_sorted_keys(&branch_counts, BRANCH_MISPREDICTED, &pcs);
+  fprintf(stderr, "Conditional jumps with the most mispredictions:\n");
+  for (uint32_t i = 0; i < num_pcs && i < NUM_MISPREDICTED_BRANCHES; i++) {
+    uint64_t *counts = pc_map_counts(&branch_counts, pcs[i]);
+    if (counts[BRANCH_MISPREDICTED] == 0) {
+      break;
+    }
+    Instruction *instr = machine_to_assembly(read_storage_raw(pcs[i]));
+    char *instr_str = assembly_to_str(instr);
+    fprintf(stderr,
+            "  %-5s %10u %-24s %10" PRIu64 " executed %6.2f%% taken %6.2f%% "
+            "mispredicted\n",
+            pcs[i] >> 31 ? "SRAM" : "EPROM", pcs[i] & 0x7FFFFFFF, instr_str,
+            counts[BRANCH_EXECUTED],
+            100.0 * counts[BRANCH_TAKEN] / counts[BRANCH_EXECUTED],
+            100.0 * counts[BRANCH_MISPREDICTED] / counts[BRANCH_EXECUTED]);
+    free(instr_str);
+    free(instr);
+  }
+  free(pcs);
+}
@@ -0,0 +1,223 @@
+#include "../include/breakpoints.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+uint32_t num_breakpoints = 0;
+
+// one bit per cell that can hold an instruction
+static uint8_t *eprom_breakpoints = NULL;
+static uint8_t *sram_breakpoints = NULL;
+
+typedef struct {
+  uint32_t addr;
+  Condition condition;
+} Conditional_Breakpoint;
+
+// looked at only after the bitmap hit, breakpoints without an entry here
+// always stop
+static Conditional_Breakpoint
+    conditional_breakpoints[MAX_CONDITIONAL_BREAKPOINTS];
+static uint8_t num_conditional_breakpoints = 0;
+
+// address of the first instruction in each line, one table per file
+typedef struct {
+  uint32_t *line_addrs;
+  uint32_t num_lines;
+} Line_Table;
+
+static Line_Table line_tables[NUM_PRGRM_TYPES];
+
+void init_breakpoints() {
+  eprom_breakpoints = calloc(EPROM_SIZE / 8, sizeof(uint8_t));
+  sram_breakpoints = calloc(((uint64_t)sram_size + 7) / 8, sizeof(uint8_t));
+  if (!eprom_breakpoints || !sram_breakpoints) {
+    fprintf(stderr, "Error: Failed to allocate the breakpoints\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// the UART and everything outside of EPROM and SRAM has no bitmap
+static uint8_t *bitmap_of_addr(uint32_t addr, uint32_t *idx) {
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    *idx = addr;
+    return addr < EPROM_SIZE ? eprom_breakpoints : NULL;
+  case UART_CONST:
+    return NULL;
+  default: // SRAM_CONST
+    *idx = addr & 0x7FFFFFFF;
+    return *idx < sram_size ? sram_breakpoints : NULL;
+  }
+}
+
+bool is_breakpoint(uint32_t addr) {
+  uint32_t idx;
+  uint8_t *bitmap = bitmap_of_addr(addr, &idx);
+  return bitmap && (bitmap[idx / 8] & (1 << (idx % 8)));
+}
+
+static Conditional_Breakpoint *conditional_breakpoint_at(uint32_t addr) {
+  for (uint8_t i = 0; i < num_conditional_breakpoints; i++) {
+    if (conditional_breakpoints[i].addr == addr) {
+      return &conditional_breakpoints[i];
+    }
+  }
+  return NULL;
+}
+
+// returns false if there can't be an instruction at the address
+bool toggle_breakpoint(uint32_t addr) {
+  uint32_t idx;
+  uint8_t *bitmap = bitmap_of_addr(addr, &idx);
+  if (!bitmap) {
+    return false;
+  }
+  bitmap[idx / 8] ^= 1 << (idx % 8);
+  if (bitmap[idx / 8] & (1 << (idx % 8))) {
+    num_breakpoints++;
+  } else {
+    num_breakpoints--;
+    Conditional_Breakpoint *conditional_breakpoint =
+        conditional_breakpoint_at(addr);
+    if (conditional_breakpoint) {
+      *conditional_breakpoint =
+          conditional_breakpoints[--num_conditional_breakpoints];
+    }
+  }
+  return true;
+}
+
+// sets the breakpoint or replaces its condition, returns false if there
+// can't be an instruction at the address or there are too many conditions
+bool set_conditional_breakpoint(uint32_t addr, Condition *condition) {
+  Conditional_Breakpoint *conditional_breakpoint =
+      conditional_breakpoint_at(addr);
+  if (!conditional_breakpoint) {
+    if (num_conditional_breakpoints == MAX_CONDITIONAL_BREAKPOINTS ||
+        !bitmap_of_addr(addr, &(uint32_t){0})) {
+      return false;
+    }
+    if (!is_breakpoint(addr)) {
+      toggle_breakpoint(addr);
+    }
+    conditional_breakpoint =
+        &conditional_breakpoints[num_conditional_breakpoints++];
+    conditional_breakpoint->addr = addr;
+  }
+  conditional_breakpoint->condition = *condition;
+  return true;
+}
+
+bool breakpoint_hits(uint32_t addr) {
+  if (!is_breakpoint(addr)) {
+    return false;
+  }
+  if (num_conditional_breakpoints == 0) {
+    return true;
+  }
+  Conditional_Breakpoint *conditional_breakpoint =
+      conditional_breakpoint_at(addr);
+  return !conditional_breakpoint ||
+         eval_condition(&conditional_breakpoint->condition);
+}
+
+void record_line_addr(Program_Type prgrm_type, uint32_t line, uint32_t addr) {
+  Line_Table *table = &line_tables[prgrm_type];
+  if (line >= table->num_lines) {
+    uint32_t *temp =
+        realloc(table->line_addrs, sizeof(uint32_t) * ((uint64_t)line + 1));
+    if (temp == NULL) {
+      fprintf(stderr, "Error: Failed to allocate the lines of the program\n");
+      exit(EXIT_FAILURE);
+    }
+    table->line_addrs = temp;
+    for (uint32_t i = table->num_lines; i <= line; i++) {
+      table->line_addrs[i] = NO_ADDR;
+    }
+    table->num_lines = line + 1;
+  }
+  if (table->line_addrs[line] == NO_ADDR) {
+    table->line_addrs[line] = addr;
+  }
+}
+
+uint32_t addr_of_line(Program_Type prgrm_type, uint32_t line) {
+  Line_Table *table = &line_tables[prgrm_type];
+  return line < table->num_lines ? table->line_addrs[line] : NO_ADDR;
+}
+
+// the file with the instruction at the address, false if no file was loaded
+// there, e.g. for the EPROM program that is built in
+static bool prgrm_of_addr(uint32_t addr, Program_Type *prgrm_type) {
+  uint32_t sram_start = (uint32_t)SRAM_CONST << 30;
+  if (addr < num_instrs_start_prgrm) {
+    *prgrm_type = EPROM_START_PRGRM;
+  } else if (addr >= sram_start && addr < sram_start + num_instrs_isrs) {
+    *prgrm_type = ISR_PRGRMS;
+  } else if (addr >= sram_start + num_instrs_isrs &&
+             addr < sram_start + num_instrs_isrs + num_instrs_prgrm) {
+    *prgrm_type = SRAM_PRGRM;
+  } else {
+    return false;
+  }
+  return line_tables[*prgrm_type].num_lines > 0;
+}
+
+// the line of the file with the instruction at the address and in
+// prgrm_type that file, 0 if the instruction isn't part of a file
+uint32_t line_of_addr(uint32_t addr, Program_Type *prgrm_type) {
+  if (!prgrm_of_addr(addr, prgrm_type)) {
+    return 0;
+  }
+  Line_Table *table = &line_tables[*prgrm_type];
+  uint32_t line = 0;
+  for (uint32_t i = 1; i < table->num_lines; i++) {
+    if (table->line_addrs[i] == NO_ADDR) {
+      continue;
+    } else if (table->line_addrs[i] > addr) {
+      break;
+    }
+    line = i;
+  }
+  return line;
+}
+
+const char *path_of_prgrm(Program_Type prgrm_type) {
+  switch (prgrm_type) {
+  case EPROM_START_PRGRM:
+    return eprom_prgrm_path;
+  case ISR_PRGRMS:
+    return isrs_prgrm_path;
+  default: // SRAM_PRGRM
+    return sram_prgrm_path;
+  }
+}
+
+// either an address like the ones in the registers or 'l' and a line of the
+// program, 'li' for a line of the interrupt service routines and 'le' for one
+// of the EPROM program. Returns NO_ADDR if there is no instruction
+uint32_t parse_breakpoint_location(const char *str) {
+  bool is_line = str[0] == 'l';
+  Program_Type prgrm_type = SRAM_PRGRM;
+  const char *num_str = str;
+  if (is_line) {
+    num_str++;
+    if (*num_str == 'i') {
+      prgrm_type = ISR_PRGRMS;
+      num_str++;
+    } else if (*num_str == 'e') {
+      prgrm_type = EPROM_START_PRGRM;
+      num_str++;
+    }
+  }
+  char *endptr;
+  uint64_t num = strtoull(num_str, &endptr, 10);
+  if (endptr == num_str || *endptr != '\0' || num_str[0] == '-' ||
+      num >= NO_ADDR) {
+    return NO_ADDR;
+  }
+  return is_line ? addr_of_line(prgrm_type, num) : num;
+}
@@ -0,0 +1,282 @@
+#include "../include/cache.h"
+#include "../include/assemble.h"
+#include "../include/datastructures.h"
+#include "../include/interpr.h"
+#include "../include/reti.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool cache_active = false;
+Cache_Config cache_config = {.size = 1024,
+                             .assoc = 2,
+                             .line_size = 4,
+                             .replacement = CACHE_LRU,
+                             .write_policy = CACHE_WRITE_BACK};
+uint64_t cache_region_counts[NUM_MEM_TYPES][NUM_CACHE_COUNTS];
+
+static const char *replacement_to_name[] = {"lru", "fifo", "random"};
+static const char *write_policy_to_name[] = {"wb", "wt"};
+
+// the ways of a set lie next to each other, line i of set s is at index
+// s * assoc + i
+typedef struct {
+  uint32_t tag;
+  bool valid;
+  bool dirty;
+  // time of the last access for LRU, time of the fill for FIFO
+  uint64_t stamp;
+} Cache_Line;
+
+static Cache_Line *lines = NULL;
+static uint32_t num_sets, set_mask, assoc;
+static uint8_t line_bits, set_bits, assoc_bits;
+static bool write_through, lru;
+static uint64_t access_time = 0;
+static uint32_t random_state = 2463534242u;
+
+static Pc_Map pc_counts;
+static uint32_t last_pc;
+static uint64_t *last_pc_counts = NULL;
+
+static bool is_power_of_two(uint64_t num) {
+  return num > 0 && (num & (num - 1)) == 0;
+}
+
+static uint8_t log2_of_power_of_two(uint32_t num) {
+  uint8_t bits = 0;
+  while (num > 1) {
+    num >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+static bool parse_power_of_two(char *str, uint32_t *num) {
+  char *endptr;
+  unsigned long long tmp_val = strtoull(str, &endptr, 10);
+  if (endptr == str || *endptr != '\0' || tmp_val > (1u << 31) ||
+      !is_power_of_two(tmp_val)) {
+    return false;
+  }
+  *num = tmp_val;
+  return true;
+}
+
+// SIZE:ASSOC:LINE[:lru|fifo|random[:wb|wt]]
+bool parse_cache_config(const char *spec) {
+  char buffer[64];
+  if (strlen(spec) >= sizeof(buffer)) {
+    return false;
+  }
+  strcpy(buffer, spec);
+
+  char *fields[5];
+  uint8_t num_fields = 0;
+  char *saveptr;
+  for (char *field = strtok_r(buffer, ":", &saveptr); field;
+       field = strtok_r(NULL, ":", &saveptr)) {
+    if (num_fields == 5) {
+      return false;
+    }
+    fields[num_fields++] = field;
+  }
+  if (num_fields < 3) {
+    return false;
+  }
+
+  Cache_Config config = cache_config;
+  if (!parse_power_of_two(fields[0], &config.size) ||
+      !parse_power_of_two(fields[1], &config.assoc) ||
+      !parse_power_of_two(fields[2], &config.line_size) ||
+      (uint64_t)config.assoc * config.line_size > config.size) {
+    return false;
+  }
+
+  config.replacement = CACHE_LRU;
+  if (num_fields > 3) {
+    if (strcmp(fields[3], "lru") == 0) {
+      config.replacement = CACHE_LRU;
+    } else if (strcmp(fields[3], "fifo") == 0) {
+      config.replacement = CACHE_FIFO;
+    } else if (strcmp(fields[3], "random") == 0) {
+      config.replacement = CACHE_RANDOM;
+    } else {
+      return false;
+    }
+  }
+
+  config.write_policy = CACHE_WRITE_BACK;
+  if (num_fields > 4) {
+    if (strcmp(fields[4], "wb") == 0) {
+      config.write_policy = CACHE_WRITE_BACK;
+    } else if (strcmp(fields[4], "wt") == 0) {
+      config.write_policy = CACHE_WRITE_THROUGH;
+    } else {
+      return false;
+    }
+  }
+
+  cache_config = config;
+  return true;
+}
+
+void init_cache() {
+  num_sets = cache_config.size / (cache_config.assoc * cache_config.line_size);
+  set_mask = num_sets - 1;
+  assoc = cache_config.assoc;
+  line_bits = log2_of_power_of_two(cache_config.line_size);
+  set_bits = log2_of_power_of_two(num_sets);
+  assoc_bits = log2_of_power_of_two(assoc);
+  write_through = cache_config.write_policy == CACHE_WRITE_THROUGH;
+  lru = cache_config.replacement == CACHE_LRU;
+  free(lines);
+  lines = calloc((size_t)num_sets * cache_config.assoc, sizeof(Cache_Line));
+  if (!lines) {
+    fprintf(stderr, "Error: Failed to allocate the cache\n");
+    exit(EXIT_FAILURE);
+  }
+  memset(cache_region_counts, 0, sizeof(cache_region_counts));
+  access_time = 0;
+  init_pc_map(&pc_counts);
+  last_pc_counts = NULL;
+}
+
+static uint32_t next_random() {
+  // xorshift32, deterministic so that runs are reproducible
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+static Cache_Line *choose_victim(Cache_Line *set) {
+  for (uint32_t i = 0; i < assoc; i++) {
+    if (!set[i].valid) {
+      return &set[i];
+    }
+  }
+  if (cache_config.replacement == CACHE_RANDOM) {
+    return &set[next_random() & (assoc - 1)];
+  }
+  // LRU and FIFO only differ in when the stamp gets updated
+  Cache_Line *victim = &set[0];
+  for (uint32_t i = 1; i < assoc; i++) {
+    if (set[i].stamp < victim->stamp) {
+      victim = &set[i];
+    }
+  }
+  return victim;
+}
+
+// the UART is not cached, because its registers change without the CPU.
+// Called for every data access, so the configuration is precomputed in
+// init_cache and the counters of the last PC are remembered
+bool cache_access(uint32_t addr, bool is_write) {
+  if (addr >> 30 == UART_CONST) {
+    return false;
+  }
+  if (!last_pc_counts || last_pc != instr_pc) {
+    last_pc = instr_pc;
+    last_pc_counts = pc_map_counts(&pc_counts, instr_pc);
+  }
+  uint64_t *region_counts = cache_region_counts[mem_type_of_addr(addr)];
+  access_time++;
+
+  // the region bits stay part of the tag, so that e.g. EPROM address 0 and
+  // SRAM address 0 are different lines
+  uint32_t line_addr = addr >> line_bits;
+  uint32_t tag = line_addr >> set_bits;
+  Cache_Line *set = &lines[(line_addr & set_mask) << assoc_bits];
+
+  Cache_Count result = CACHE_MISSES;
+  Cache_Line *line = NULL;
+  for (uint32_t i = 0; i < assoc; i++) {
+    if (set[i].tag == tag && set[i].valid) {
+      result = CACHE_HITS;
+      line = &set[i];
+      break;
+    }
+  }
+  region_counts[result]++;
+  last_pc_counts[result]++;
+
+  if (line) {
+    if (lru) {
+      line->stamp = access_time;
+    }
+  } else if (!(is_write && write_through)) {
+    // write-through caches don't allocate a line on a write miss
+    line = choose_victim(set);
+    if (line->valid && line->dirty) {
+      region_counts[CACHE_WRITEBACKS]++;
+      last_pc_counts[CACHE_WRITEBACKS]++;
+    }
+    *line = (Cache_Line){.tag = tag, .valid = true, .stamp = access_time};
+  }
+
+  if (is_write) {
+    if (write_through) {
+      region_counts[CACHE_WRITE_THROUGHS]++;
+      last_pc_counts[CACHE_WRITE_THROUGHS]++;
+    } else {
+      line->dirty = true;
+    }
+  }
+  return result == CACHE_HITS;
+}
+
+static void print_cache_counts(const char *name, uint64_t counts[]) {
+  uint64_t accesses = counts[CACHE_HITS] + counts[CACHE_MISSES];
+  fprintf(stderr, "  %-17s %10" PRIu64 " hits %10" PRIu64 " misses", name,
+          counts[CACHE_HITS], counts[CACHE_MISSES]);
+  if (accesses > 0) {
+    fprintf(stderr, " (%6.2f%% hits)",
+            100.0 * counts[CACHE_HITS] / accesses);
+  } else {
+    fprintf(stderr, "               ");
+  }
+  fprintf(stderr, " %10" PRIu64 " writebacks %10" PRIu64 " write-throughs\n",
+          counts[CACHE_WRITEBACKS], counts[CACHE_WRITE_THROUGHS]);
+}
+
+void print_cache_stats() {
+  fprintf(stderr,
+          "Cache statistics (%u words, %u-way, %u words per line, %s, %s):\n",
+          cache_config.size, cache_config.assoc, cache_config.line_size,
+          replacement_to_name[cache_config.replacement],
+          write_policy_to_name[cache_config.write_policy]);
+  uint64_t total_counts[NUM_CACHE_COUNTS] = {0};
+  for (uint8_t i = EPROM; i < NUM_MEM_TYPES; i++) {
+    if (i == UART) {
+      continue;
+    }
+    print_cache_counts(mem_type_to_name[i], cache_region_counts[i]);
+    for (uint8_t j = 0; j < NUM_CACHE_COUNTS; j++) {
+      total_counts[j] += cache_region_counts[i][j];
+    }
+  }
+  print_cache_counts("Total", total_counts);
+
+  uint32_t *pcs;
+  uint32_t num_pcs = pc_map_sorted_keys(&pc_counts, CACHE_MISSES, &pcs);
+  fprintf(stderr, "Instructions with the most misses:\n");
+  for (uint32_t i = 0; i < num_pcs && i < NUM_CACHE_MISS_PCS; i++) {
+    uint64_t *counts = pc_map_counts(&pc_counts, pcs[i]);
+    if (counts[CACHE_MISSES] == 0) {
+      break;
+    }
+    Instruction *instr = machine_to_assembly(read_storage_raw(pcs[i]));
+    char *instr_str = assembly_to_str(instr);
+    fprintf(stderr,
+            "  %-5s %10u %-24s %10" PRIu64 " misses %10" PRIu64
+            " hits %10" PRIu64 " writebacks\n",
+            pcs[i] >> 31 ? "SRAM" : "EPROM", pcs[i] & 0x7FFFFFFF, instr_str, counts[CACHE_MISSES], counts[CACHE_HITS],
+            counts[CACHE_WRITEBACKS]);
+    free(instr_str);
+    free(instr);
+  }
+  free(pcs);
+}
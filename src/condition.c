@@ -0,0 +1,305 @@
+#include "../include/condition.h"
+#include "../include/assemble.h"
+#include "../include/reti.h"
+#include "../include/uart.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// recursive descent with the precedence || < && < comparison < + - < * <
+// unary - ! < operands, every rule emits its code after its operands
+typedef struct {
+  const char *pntr;
+  Condition *condition;
+  uint8_t depth;
+  uint8_t max_depth;
+  bool error;
+} Compiler;
+
+static bool parse_or(Compiler *compiler);
+
+static void skip_space(Compiler *compiler) {
+  while (*compiler->pntr == ' ' || *compiler->pntr == '\t') {
+    compiler->pntr++;
+  }
+}
+
+static bool accept(Compiler *compiler, const char *token) {
+  skip_space(compiler);
+  size_t len = strlen(token);
+  if (strncmp(compiler->pntr, token, len) == 0) {
+    compiler->pntr += len;
+    return true;
+  }
+  return false;
+}
+
+static void emit(Compiler *compiler, uint8_t byte) {
+  if (compiler->condition->len == MAX_CONDITION_CODE) {
+    compiler->error = true;
+    return;
+  }
+  compiler->condition->code[compiler->condition->len++] = byte;
+}
+
+// keeps track of the height of the stack while evaluating
+static void push(Compiler *compiler) {
+  compiler->depth++;
+  if (compiler->depth > compiler->max_depth) {
+    compiler->max_depth = compiler->depth;
+  }
+}
+
+static void emit_binary(Compiler *compiler, Condition_Op op) {
+  emit(compiler, op);
+  compiler->depth--;
+}
+
+static bool parse_operand(Compiler *compiler) {
+  skip_space(compiler);
+  if (isdigit(*compiler->pntr)) {
+    char *endptr;
+    uint64_t value = strtoull(compiler->pntr, &endptr, 10);
+    if (value > UINT32_MAX) {
+      return false;
+    }
+    compiler->pntr = endptr;
+    emit(compiler, COND_CONST);
+    for (uint8_t i = 0; i < 4; i++) {
+      emit(compiler, (value >> (8 * i)) & 0xFF);
+    }
+    push(compiler);
+    return true;
+  }
+  if (accept(compiler, "(")) {
+    return parse_or(compiler) && accept(compiler, ")");
+  }
+  if (accept(compiler, "M[")) {
+    if (!parse_or(compiler) || !accept(compiler, "]")) {
+      return false;
+    }
+    emit(compiler, COND_MEM);
+    return true;
+  }
+  for (uint8_t reg = PC; reg <= DS; reg++) {
+    size_t len = strlen(register_code_to_name[reg]);
+    if (strncasecmp(compiler->pntr, register_code_to_name[reg], len) == 0 &&
+        !isalnum(compiler->pntr[len])) {
+      compiler->pntr += len;
+      emit(compiler, COND_REG);
+      emit(compiler, reg);
+      push(compiler);
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parse_unary(Compiler *compiler) {
+  if (accept(compiler, "-")) {
+    bool res = parse_unary(compiler);
+    emit(compiler, COND_NEG);
+    return res;
+  }
+  if (accept(compiler, "!")) {
+    bool res = parse_unary(compiler);
+    emit(compiler, COND_NOT);
+    return res;
+  }
+  return parse_operand(compiler);
+}
+
+static bool parse_product(Compiler *compiler) {
+  if (!parse_unary(compiler)) {
+    return false;
+  }
+  while (accept(compiler, "*")) {
+    if (!parse_unary(compiler)) {
+      return false;
+    }
+    emit_binary(compiler, COND_MUL);
+  }
+  return true;
+}
+
+static bool parse_sum(Compiler *compiler) {
+  if (!parse_product(compiler)) {
+    return false;
+  }
+  while (true) {
+    Condition_Op op;
+    if (accept(compiler, "+")) {
+      op = COND_ADD;
+    } else if (accept(compiler, "-")) {
+      op = COND_SUB;
+    } else {
+      return true;
+    }
+    if (!parse_product(compiler)) {
+      return false;
+    }
+    emit_binary(compiler, op);
+  }
+}
+
+static bool parse_comparison(Compiler *compiler) {
+  if (!parse_sum(compiler)) {
+    return false;
+  }
+  // the two character operators have to be tried first
+  static const char *tokens[] = {"==", "!=", "<=", ">=", "<", ">"};
+  static const Condition_Op ops[] = {COND_EQ, COND_NE, COND_LE,
+                                     COND_GE, COND_LT, COND_GT};
+  for (uint8_t i = 0; i < 6; i++) {
+    if (accept(compiler, tokens[i])) {
+      if (!parse_sum(compiler)) {
+        return false;
+      }
+      emit_binary(compiler, ops[i]);
+      return true;
+    }
+  }
+  return true;
+}
+
+static bool parse_and(Compiler *compiler) {
+  if (!parse_comparison(compiler)) {
+    return false;
+  }
+  while (accept(compiler, "&&")) {
+    if (!parse_comparison(compiler)) {
+      return false;
+    }
+    emit_binary(compiler, COND_AND);
+  }
+  return true;
+}
+
+static bool parse_or(Compiler *compiler) {
+  if (!parse_and(compiler)) {
+    return false;
+  }
+  while (accept(compiler, "||")) {
+    if (!parse_and(compiler)) {
+      return false;
+    }
+    emit_binary(compiler, COND_OR);
+  }
+  return true;
+}
+
+// e.g. "ACC < 0 && M[DS+5] == 42", returns false if the text is invalid
+bool compile_condition(const char *str, Condition *condition) {
+  Compiler compiler = {str, condition, 0, 0, false};
+  condition->len = 0;
+  if (!parse_or(&compiler)) {
+    return false;
+  }
+  skip_space(&compiler);
+  emit(&compiler, COND_END);
+  return *compiler.pntr == '\0' && !compiler.error &&
+         compiler.max_depth <= MAX_CONDITION_STACK;
+}
+
+// the registers of the UART are read like the box shows them, a LOAD of the
+// program would also warn about reading the send register. A condition may
+// name any address, what lies outside of a memory reads as 0
+static uint32_t read_cond_mem(uint32_t addr) {
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    return addr < num_instrs_start_prgrm ? eprom[addr] : 0;
+  case UART_CONST: {
+    uint32_t idx = addr & 0x3FFFFFFF;
+    return idx < NUM_UART_ADDRESSES ? uart[idx] : 0;
+  }
+  default: { // SRAM_CONST
+    // only cells that were already written lie in the file
+    uint64_t idx = addr & 0x7FFFFFFF;
+    fseek(sram, 0, SEEK_END);
+    if ((idx + 1) * sizeof(uint32_t) > (uint64_t)ftell(sram)) {
+      return 0;
+    }
+    return read_file(sram, idx);
+  }
+  }
+}
+
+// the values are signed like the ones in the registers of the RETI
+int32_t eval_expression(const Condition *condition) {
+  int32_t stack[MAX_CONDITION_STACK];
+  int32_t *top = stack - 1;
+  const uint8_t *pc = condition->code;
+  while (true) {
+    switch (*pc++) {
+    case COND_CONST:
+      *++top = pc[0] | pc[1] << 8 | pc[2] << 16 | (uint32_t)pc[3] << 24;
+      pc += 4;
+      break;
+    case COND_REG:
+      *++top = regs[*pc++];
+      break;
+    case COND_MEM:
+      *top = read_cond_mem(*top);
+      break;
+    case COND_NEG:
+      *top = -(uint32_t)*top;
+      break;
+    case COND_NOT:
+      *top = !*top;
+      break;
+    case COND_ADD:
+      top--;
+      *top = (uint32_t)top[0] + (uint32_t)top[1];
+      break;
+    case COND_SUB:
+      top--;
+      *top = (uint32_t)top[0] - (uint32_t)top[1];
+      break;
+    case COND_MUL:
+      top--;
+      *top = (uint32_t)top[0] * (uint32_t)top[1];
+      break;
+    case COND_EQ:
+      top--;
+      *top = top[0] == top[1];
+      break;
+    case COND_NE:
+      top--;
+      *top = top[0] != top[1];
+      break;
+    case COND_LT:
+      top--;
+      *top = top[0] < top[1];
+      break;
+    case COND_LE:
+      top--;
+      *top = top[0] <= top[1];
+      break;
+    case COND_GT:
+      top--;
+      *top = top[0] > top[1];
+      break;
+    case COND_GE:
+      top--;
+      *top = top[0] >= top[1];
+      break;
+    case COND_AND:
+      top--;
+      *top = top[0] && top[1];
+      break;
+    case COND_OR:
+      top--;
+      *top = top[0] || top[1];
+      break;
+    default: // COND_END
+      return *top;
+    }
+  }
+}
+
+bool eval_condition(const Condition *condition) {
+  return eval_expression(condition) != 0;
+}
@@ -0,0 +1,1008 @@
+#include "../include/dap.h"
+#include "../include/assemble.h"
+#include "../include/breakpoints.h"
+#include "../include/condition.h"
+#include "../include/debug.h"
+#include "../include/disasm_cache.h"
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/json.h"
+#include "../include/parse_args.h"
+#include "../include/record.h"
+#include "../include/reti.h"
+#include "../include/snapshot.h"
+#include "../include/special_opts.h"
+#include "../include/uart.h"
+#include "../include/undo.h"
+#include "../include/watchpoints.h"
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+bool dap_active = false;
+atomic_bool dap_requests_pending = false;
+
+typedef struct Dap_Message {
+  Json_Value *value;
+  struct Dap_Message *next;
+} Dap_Message;
+
+// the requests are read by a thread of their own, so that they reach the
+// interpreter while it runs
+static pthread_t reader_thread;
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static Dap_Message *queue_head = NULL;
+static Dap_Message *queue_tail = NULL;
+static bool input_closed = false;
+
+typedef enum {
+  DAP_EVENT_INITIALIZED = 0b01,
+  DAP_EVENT_STOPPED = 0b10,
+} Dap_Pending_Event;
+
+typedef struct {
+  const char *name;
+  // changes the machine, which isn't possible while an instruction is
+  // waiting for input
+  bool runs_machine;
+  // returns an error message or NULL, resume continues the execution
+  const char *(*handle)(const Json_Value *arguments, Json_Writer *body,
+                        bool *resume);
+} Dap_Command;
+
+static uint64_t seq = 1;
+static uint8_t pending_events = 0;
+static bool configuration_done = false;
+static bool stop_on_entry = false;
+static bool step_in_requested = false;
+// requests that run the machine have to wait until it stops
+static bool machine_running = false;
+static bool pause_requested = false;
+
+static const char *stop_reason = "entry";
+static char stop_description[MAX_LEN_WATCHPOINT_HIT];
+
+// the breakpoints of the editor replace all the ones set before in the same
+// file
+static uint32_t source_breakpoints[NUM_PRGRM_TYPES]
+                                  [MAX_DAP_SOURCE_BREAKPOINTS];
+static uint32_t num_source_breakpoints[NUM_PRGRM_TYPES] = {0};
+static uint32_t instr_breakpoints[MAX_DAP_SOURCE_BREAKPOINTS];
+static uint32_t num_instr_breakpoints = 0;
+
+// the input an instruction is waiting for
+static char *pending_input = NULL;
+static uint8_t pending_input_max_len;
+
+static void send_message(Json_Writer *writer) {
+  printf("Content-Length: %zu\r\n\r\n", writer->len);
+  fwrite(writer->data, 1, writer->len, stdout);
+  fflush(stdout);
+}
+
+// the body is written by the caller and closed by send_event
+static void begin_event(Json_Writer *writer, const char *event) {
+  json_begin_object(writer, NULL);
+  json_uint(writer, "seq", seq++);
+  json_str(writer, "type", "event");
+  json_str(writer, "event", event);
+  json_begin_object(writer, "body");
+}
+
+static void send_event(Json_Writer *writer) {
+  json_end_object(writer);
+  json_end_object(writer);
+  send_message(writer);
+  fin_json_writer(writer);
+}
+
+void send_dap_output(const char *category, const char *output) {
+  Json_Writer writer = {NULL, 0, 0};
+  begin_event(&writer, "output");
+  json_str(&writer, "category", category);
+  json_str(&writer, "output", output);
+  send_event(&writer);
+}
+
+static void send_stopped_event() {
+  Json_Writer writer = {NULL, 0, 0};
+  begin_event(&writer, "stopped");
+  json_str(&writer, "reason", stop_reason);
+  if (stop_description[0] != '\0') {
+    json_str(&writer, "description", stop_description);
+  }
+  json_uint(&writer, "threadId", DAP_THREAD_ID);
+  json_bool(&writer, "allThreadsStopped", true);
+  send_event(&writer);
+  stop_description[0] = '\0';
+}
+
+static void *read_dap_messages(void *arg) {
+  char header[MAX_LEN_DAP_HEADER];
+  while (true) {
+    size_t content_len = 0;
+    bool header_complete = false;
+    while (fgets(header, sizeof(header), stdin)) {
+      if (strcmp(header, "\r\n") == 0 || strcmp(header, "\n") == 0) {
+        header_complete = true;
+        break;
+      }
+      if (strncasecmp(header, "Content-Length:", 15) == 0) {
+        content_len = strtoul(header + 15, NULL, 10);
+      }
+    }
+    char *content = header_complete ? malloc(content_len + 1) : NULL;
+    if (!content || fread(content, 1, content_len, stdin) != content_len) {
+      free(content);
+      break;
+    }
+    content[content_len] = '\0';
+    Json_Value *value = parse_json(content);
+    free(content);
+    if (!value) {
+      fprintf(stderr,
+              "Error: Invalid message of the debug adapter protocol\n");
+      continue;
+    }
+
+    Dap_Message *message = malloc(sizeof(Dap_Message));
+    message->value = value;
+    message->next = NULL;
+    pthread_mutex_lock(&queue_mutex);
+    if (queue_tail) {
+      queue_tail->next = message;
+    } else {
+      queue_head = message;
+    }
+    queue_tail = message;
+    atomic_store(&dap_requests_pending, true);
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+  }
+
+  pthread_mutex_lock(&queue_mutex);
+  input_closed = true;
+  atomic_store(&dap_requests_pending, true);
+  pthread_cond_signal(&queue_cond);
+  pthread_mutex_unlock(&queue_mutex);
+  return NULL;
+}
+
+void init_dap() {
+  if (pthread_create(&reader_thread, NULL, read_dap_messages, NULL) != 0) {
+    fprintf(stderr, "Error: Failed to start the debug adapter\n");
+    exit(EXIT_FAILURE);
+  }
+  pthread_detach(reader_thread);
+}
+
+static void remove_queue_head() {
+  queue_head = queue_head->next;
+  if (!queue_head) {
+    queue_tail = NULL;
+  }
+}
+
+// the editor closing the connection ends the debugging like q
+static Json_Value *next_dap_message() {
+  pthread_mutex_lock(&queue_mutex);
+  while (!queue_head && !input_closed) {
+    pthread_cond_wait(&queue_cond, &queue_mutex);
+  }
+  Dap_Message *message = queue_head;
+  if (message) {
+    remove_queue_head();
+  }
+  pthread_mutex_unlock(&queue_mutex);
+
+  if (!message) {
+    finalize();
+    exit(EXIT_SUCCESS);
+  }
+  Json_Value *value = message->value;
+  free(message);
+  return value;
+}
+
+static bool get_num_arg(const Json_Value *arguments, const char *key,
+                        int64_t *value) {
+  return json_value_num(json_get(arguments, key), value);
+}
+
+// memory references are the decimal addresses like in the registers
+static bool parse_memory_reference(const Json_Value *arguments,
+                                   int64_t *addr) {
+  const char *reference =
+      json_value_str(json_get(arguments, "memoryReference"));
+  char *endptr;
+  if (!reference) {
+    return false;
+  }
+  *addr = strtoll(reference, &endptr, 10);
+  return endptr != reference && *endptr == '\0';
+}
+
+// the IVT and the data after the program aren't instructions
+static bool holds_instr(int64_t addr) {
+  if (addr < 0 || addr > UINT32_MAX) {
+    return false;
+  }
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    return addr < num_instrs_start_prgrm;
+  case UART_CONST:
+    return false;
+  default: { // SRAM_CONST
+    uint32_t idx = addr & 0x7FFFFFFF;
+    return idx >= ivt_max_idx + 1 && idx < num_instrs_isrs + num_instrs_prgrm;
+  }
+  }
+}
+
+static void write_addr(Json_Writer *body, const char *key, uint32_t addr) {
+  char addr_str[MAX_DIGITS_ADDR_DEC + 1];
+  snprintf(addr_str, sizeof(addr_str), "%u", addr);
+  json_str(body, key, addr_str);
+}
+
+static const char *file_name(const char *path) {
+  const char *name = strrchr(path, '/');
+  return name ? name + 1 : path;
+}
+
+static void write_source(Json_Writer *body, Program_Type prgrm_type) {
+  const char *path = path_of_prgrm(prgrm_type);
+  json_begin_object(body, "source");
+  json_str(body, "name", file_name(path));
+  json_str(body, "path", path);
+  json_end_object(body);
+}
+
+// the loaded file the source refers to, without a path it's the program
+static bool prgrm_of_source(const Json_Value *arguments,
+                            Program_Type *prgrm_type) {
+  const char *path =
+      json_value_str(json_get(json_get(arguments, "source"), "path"));
+  *prgrm_type = SRAM_PRGRM;
+  if (!path) {
+    return true;
+  }
+  const Program_Type prgrm_types[] = {SRAM_PRGRM, ISR_PRGRMS,
+                                      EPROM_START_PRGRM};
+  for (uint8_t i = 0; i < NUM_PRGRM_TYPES; i++) {
+    const char *prgrm_path = path_of_prgrm(prgrm_types[i]);
+    if (prgrm_path[0] != '\0' &&
+        strcmp(file_name(path), file_name(prgrm_path)) == 0) {
+      *prgrm_type = prgrm_types[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+static void clear_breakpoints(uint32_t *addrs, uint32_t *num_addrs) {
+  for (uint32_t i = 0; i < *num_addrs; i++) {
+    if (is_breakpoint(addrs[i])) {
+      toggle_breakpoint(addrs[i]);
+    }
+  }
+  *num_addrs = 0;
+}
+
+// a condition makes it a conditional breakpoint like with K
+static const char *set_breakpoint(uint32_t addr, const Json_Value *breakpoint,
+                                  uint32_t *addrs, uint32_t *num_addrs) {
+  if (*num_addrs == MAX_DAP_SOURCE_BREAKPOINTS) {
+    return "Too many breakpoints";
+  }
+  const char *condition_str =
+      json_value_str(json_get(breakpoint, "condition"));
+  if (condition_str && condition_str[0] != '\0') {
+    Condition condition;
+    if (!compile_condition(condition_str, &condition)) {
+      return "Invalid condition";
+    } else if (!set_conditional_breakpoint(addr, &condition)) {
+      return "Too many conditions";
+    }
+  } else if (!is_breakpoint(addr) && !toggle_breakpoint(addr)) {
+    return "No instruction at this address";
+  }
+  addrs[(*num_addrs)++] = addr;
+  return NULL;
+}
+
+static const char *initialize_cmd(const Json_Value *arguments,
+                                  Json_Writer *body, bool *resume) {
+  json_bool(body, "supportsConfigurationDoneRequest", true);
+  json_bool(body, "supportsConditionalBreakpoints", true);
+  json_bool(body, "supportsInstructionBreakpoints", true);
+  json_bool(body, "supportsStepBack", true);
+  json_bool(body, "supportsRestartRequest", true);
+  json_bool(body, "supportsDisassembleRequest", true);
+  json_bool(body, "supportsReadMemoryRequest", true);
+  json_bool(body, "supportsEvaluateForHovers", true);
+  json_bool(body, "supportsSetVariable", true);
+  json_bool(body, "supportsTerminateRequest", true);
+  pending_events |= DAP_EVENT_INITIALIZED;
+  return NULL;
+}
+
+// the program was already loaded from the command line
+static const char *launch_cmd(const Json_Value *arguments, Json_Writer *body,
+                              bool *resume) {
+  const Json_Value *entry = json_get(arguments, "stopOnEntry");
+  stop_on_entry = entry && entry->type == JSON_BOOL && entry->num;
+  return NULL;
+}
+
+static const char *set_breakpoints_cmd(const Json_Value *arguments,
+                                       Json_Writer *body, bool *resume) {
+  const Json_Value *breakpoints = json_get(arguments, "breakpoints");
+  Program_Type prgrm_type;
+  bool is_prgrm = prgrm_of_source(arguments, &prgrm_type);
+  if (is_prgrm) {
+    clear_breakpoints(source_breakpoints[prgrm_type],
+                      &num_source_breakpoints[prgrm_type]);
+  }
+  json_begin_array(body, "breakpoints");
+  for (uint32_t i = 0; breakpoints && i < breakpoints->num_children; i++) {
+    const Json_Value *breakpoint = &breakpoints->children[i];
+    int64_t line = 0;
+    get_num_arg(breakpoint, "line", &line);
+    uint32_t addr = is_prgrm && line > 0 && line < NO_ADDR
+                        ? addr_of_line(prgrm_type, line)
+                        : NO_ADDR;
+    const char *error = addr == NO_ADDR
+                            ? "No instruction in this line of the program"
+                            : set_breakpoint(
+                                  addr, breakpoint,
+                                  source_breakpoints[prgrm_type],
+                                  &num_source_breakpoints[prgrm_type]);
+    json_begin_object(body, NULL);
+    json_bool(body, "verified", !error);
+    json_int(body, "line", line);
+    if (error) {
+      json_str(body, "message", error);
+    } else {
+      write_addr(body, "instructionReference", addr);
+    }
+    json_end_object(body);
+  }
+  json_end_array(body);
+  return NULL;
+}
+
+static const char *set_instr_breakpoints_cmd(const Json_Value *arguments,
+                                             Json_Writer *body, bool *resume) {
+  const Json_Value *breakpoints = json_get(arguments, "breakpoints");
+  clear_breakpoints(instr_breakpoints, &num_instr_breakpoints);
+  json_begin_array(body, "breakpoints");
+  for (uint32_t i = 0; breakpoints && i < breakpoints->num_children; i++) {
+    const Json_Value *breakpoint = &breakpoints->children[i];
+    const char *reference =
+        json_value_str(json_get(breakpoint, "instructionReference"));
+    int64_t offset = 0;
+    get_num_arg(breakpoint, "offset", &offset);
+    int64_t addr = reference ? strtoll(reference, NULL, 10) + offset : -1;
+    const char *error = !holds_instr(addr)
+                            ? "No instruction at this address"
+                            : set_breakpoint(addr, breakpoint,
+                                             instr_breakpoints,
+                                             &num_instr_breakpoints);
+    json_begin_object(body, NULL);
+    json_bool(body, "verified", !error);
+    if (error) {
+      json_str(body, "message", error);
+    }
+    json_end_object(body);
+  }
+  json_end_array(body);
+  return NULL;
+}
+
+static const char *set_exception_breakpoints_cmd(const Json_Value *arguments,
+                                                 Json_Writer *body,
+                                                 bool *resume) {
+  return NULL;
+}
+
+static const char *configuration_done_cmd(const Json_Value *arguments,
+                                          Json_Writer *body, bool *resume) {
+  configuration_done = true;
+  if (stop_on_entry) {
+    pending_events |= DAP_EVENT_STOPPED;
+  } else {
+    breakpoint_encountered = false;
+    stop_reason = "breakpoint";
+    *resume = true;
+  }
+  return NULL;
+}
+
+static const char *threads_cmd(const Json_Value *arguments, Json_Writer *body,
+                               bool *resume) {
+  json_begin_array(body, "threads");
+  json_begin_object(body, NULL);
+  json_uint(body, "id", DAP_THREAD_ID);
+  json_str(body, "name", "RETI");
+  json_end_object(body);
+  json_end_array(body);
+  return NULL;
+}
+
+static const char *stack_trace_cmd(const Json_Value *arguments,
+                                   Json_Writer *body, bool *resume) {
+  uint32_t pc = regs[PC];
+  char name[ASSEMBLY_STR_SIZE + MAX_DIGITS_ADDR_DEC + 3];
+  snprintf(name, sizeof(name), "%u: %s", pc,
+           holds_instr(pc) ? cached_assembly_str(pc, read_storage_raw(pc))
+                           : "??");
+  Program_Type prgrm_type;
+  uint32_t line = line_of_addr(pc, &prgrm_type);
+
+  json_begin_array(body, "stackFrames");
+  json_begin_object(body, NULL);
+  json_uint(body, "id", 0);
+  json_str(body, "name", name);
+  write_addr(body, "instructionPointerReference", pc);
+  if (line > 0) {
+    write_source(body, prgrm_type);
+    json_uint(body, "line", line);
+  } else {
+    // e.g. in the EPROM program that is built in
+    json_uint(body, "line", 0);
+    json_str(body, "presentationHint", "subtle");
+  }
+  json_uint(body, "column", 1);
+  json_end_object(body);
+  json_end_array(body);
+  json_uint(body, "totalFrames", 1);
+  return NULL;
+}
+
+static void write_scope(Json_Writer *body, const char *name,
+                        Dap_Scope reference) {
+  json_begin_object(body, NULL);
+  json_str(body, "name", name);
+  json_uint(body, "variablesReference", reference);
+  json_bool(body, "expensive", false);
+  json_end_object(body);
+}
+
+static const char *scopes_cmd(const Json_Value *arguments, Json_Writer *body,
+                              bool *resume) {
+  json_begin_array(body, "scopes");
+  write_scope(body, "Registers", DAP_REGISTERS_SCOPE);
+  write_scope(body, "UART", DAP_UART_SCOPE);
+  write_scope(body, "Interrupts", DAP_ISR_SCOPE);
+  json_end_array(body);
+  return NULL;
+}
+
+static void write_value(Json_Writer *body, const char *format, ...) {
+  char value[MAX_LEN_DAP_OUTPUT + 1];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(value, sizeof(value), format, args);
+  va_end(args);
+  json_str(body, "value", value);
+}
+
+static void write_variable(Json_Writer *body, const char *name,
+                           const char *value) {
+  json_begin_object(body, NULL);
+  json_str(body, "name", name);
+  json_str(body, "value", value);
+  json_uint(body, "variablesReference", 0);
+  json_end_object(body);
+}
+
+static void write_num_variable(Json_Writer *body, const char *name,
+                               int64_t value) {
+  json_begin_object(body, NULL);
+  json_str(body, "name", name);
+  write_value(body, "%" PRId64, value);
+  json_uint(body, "variablesReference", 0);
+  json_end_object(body);
+}
+
+static const char *variables_cmd(const Json_Value *arguments,
+                                 Json_Writer *body, bool *resume) {
+  int64_t reference = 0;
+  get_num_arg(arguments, "variablesReference", &reference);
+  json_begin_array(body, "variables");
+  switch (reference) {
+  case DAP_REGISTERS_SCOPE:
+    // the values of the registers are often addresses
+    for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+      json_begin_object(body, NULL);
+      json_str(body, "name", register_code_to_name[i]);
+      write_value(body, "%d", (int32_t)regs[i]);
+      write_addr(body, "memoryReference", regs[i]);
+      json_uint(body, "variablesReference", 0);
+      json_end_object(body);
+    }
+    break;
+  case DAP_UART_SCOPE:
+    write_num_variable(body, "R0", uart[0]);
+    write_num_variable(body, "R1", uart[1]);
+    write_num_variable(body, "R2", uart[2]);
+    write_variable(body, "datatype", datatype == STRING ? "string" : "integer");
+    write_num_variable(body, "remaining_bytes", remaining_bytes);
+    write_num_variable(body, "sending_waiting_time", sending_waiting_time);
+    write_num_variable(body, "receiving_waiting_time", receiving_waiting_time);
+    write_variable(body, "current_send_data",
+                   current_send_data ? current_send_data : "");
+    write_variable(body, "all_send_data", all_send_data ? all_send_data : "");
+    break;
+  case DAP_ISR_SCOPE:
+    write_variable(body, "active", isr_active ? "true" : "false");
+    write_num_variable(body, "current_isr", current_isr);
+    write_num_variable(body, "priority_stack_height", stack_top + 1);
+    write_variable(body, "timer_active",
+                   interrupt_timer_active ? "true" : "false");
+    write_num_variable(body, "timer_count", timer_cnt);
+    write_variable(body, "keypress_active",
+                   keypress_interrupt_active ? "true" : "false");
+    break;
+  default:
+    break;
+  }
+  json_end_array(body);
+  return NULL;
+}
+
+static const char *set_variable_cmd(const Json_Value *arguments,
+                                    Json_Writer *body, bool *resume) {
+  int64_t reference = 0;
+  get_num_arg(arguments, "variablesReference", &reference);
+  const char *name = json_value_str(json_get(arguments, "name"));
+  const char *value_str = json_value_str(json_get(arguments, "value"));
+  if (reference != DAP_REGISTERS_SCOPE || !name || !value_str) {
+    return "Only registers can be changed";
+  }
+  uint8_t reg = 0;
+  while (reg < NUM_REGISTERS &&
+         strcasecmp(name, register_code_to_name[reg]) != 0) {
+    reg++;
+  }
+  char *endptr;
+  int64_t value = strtoll(value_str, &endptr, 10);
+  if (reg == NUM_REGISTERS || endptr == value_str || *endptr != '\0' ||
+      value < INT32_MIN || value > UINT32_MAX) {
+    return "Number between -2147483648 and 4294967295 expected";
+  }
+  uint32_t values[NUM_REGISTERS];
+  memcpy(values, regs, sizeof(values));
+  values[reg] = value;
+  set_registers(values);
+  write_value(body, "%d", (int32_t)regs[reg]);
+  return NULL;
+}
+
+static const char *continue_cmd(const Json_Value *arguments, Json_Writer *body,
+                                bool *resume) {
+  breakpoint_encountered = false;
+  stop_reason = "breakpoint";
+  json_bool(body, "allThreadsContinued", true);
+  *resume = true;
+  return NULL;
+}
+
+static const char *next_cmd(const Json_Value *arguments, Json_Writer *body,
+                            bool *resume) {
+  stop_reason = "step";
+  *resume = true;
+  return NULL;
+}
+
+// like s only an INT can be stepped into, the interrupts of the timer and
+// the keyboard are entered as well
+static const char *step_in_cmd(const Json_Value *arguments, Json_Writer *body,
+                               bool *resume) {
+  Instruction *instr = machine_to_assembly(read_storage_raw(regs[PC]));
+  if (instr->op == INT) {
+    step_into_activated = true;
+  }
+  free(instr);
+  step_in_requested = true;
+  stop_reason = "step";
+  *resume = true;
+  return NULL;
+}
+
+// like f, outside of an interrupt service routine it is a normal step
+static const char *step_out_cmd(const Json_Value *arguments, Json_Writer *body,
+                                bool *resume) {
+  if (isr_active) {
+    isr_finished = false;
+  }
+  stop_reason = "step";
+  *resume = true;
+  return NULL;
+}
+
+static const char *step_back_cmd(const Json_Value *arguments,
+                                 Json_Writer *body, bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  } else if (!step_back()) {
+    return "No instructions to undo";
+  }
+  stop_reason = "step";
+  pending_events |= DAP_EVENT_STOPPED;
+  return NULL;
+}
+
+static const char *reverse_continue_cmd(const Json_Value *arguments,
+                                        Json_Writer *body, bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  }
+  step_back_to_breakpoint();
+  stop_reason = "breakpoint";
+  pending_events |= DAP_EVENT_STOPPED;
+  return NULL;
+}
+
+static const char *restart_cmd(const Json_Value *arguments, Json_Writer *body,
+                               bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  }
+  restart_from_snapshot();
+  stop_reason = "entry";
+  pending_events |= DAP_EVENT_STOPPED;
+  return NULL;
+}
+
+// a running machine stops before the next instruction, a stopped one stays
+// where it is
+static const char *pause_cmd(const Json_Value *arguments, Json_Writer *body,
+                             bool *resume) {
+  if (machine_running) {
+    pause_requested = true;
+  }
+  return NULL;
+}
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static void write_base64(Json_Writer *body, const char *key,
+                         const uint8_t *bytes, size_t len) {
+  char *encoded = malloc((len + 2) / 3 * 4 + 1);
+  size_t encoded_len = 0;
+  for (size_t i = 0; i < len; i += 3) {
+    uint32_t group = bytes[i] << 16;
+    if (i + 1 < len) {
+      group |= bytes[i + 1] << 8;
+    }
+    if (i + 2 < len) {
+      group |= bytes[i + 2];
+    }
+    encoded[encoded_len++] = base64_chars[group >> 18];
+    encoded[encoded_len++] = base64_chars[(group >> 12) & 0x3F];
+    encoded[encoded_len++] = i + 1 < len ? base64_chars[(group >> 6) & 0x3F]
+                                         : '=';
+    encoded[encoded_len++] = i + 2 < len ? base64_chars[group & 0x3F] : '=';
+  }
+  encoded[encoded_len] = '\0';
+  json_str(body, key, encoded);
+  free(encoded);
+}
+
+// the RETI addresses words, offset and count are in bytes of the big endian
+// words, so an address covers four bytes
+static const char *read_memory_cmd(const Json_Value *arguments,
+                                   Json_Writer *body, bool *resume) {
+  int64_t addr, offset = 0, count = 0;
+  if (!parse_memory_reference(arguments, &addr)) {
+    return "Invalid memory reference";
+  }
+  get_num_arg(arguments, "offset", &offset);
+  get_num_arg(arguments, "count", &count);
+  addr += offset / 4;
+  int64_t num_cells = (count + 3) / 4;
+  if (addr < 0 || addr > UINT32_MAX || num_cells < 0) {
+    return "Invalid memory reference";
+  }
+  if (num_cells > MAX_DAP_MEM_CELLS) {
+    num_cells = MAX_DAP_MEM_CELLS;
+  }
+
+  // the readable part ends at the end of the memory of the address
+  static uint32_t values[MAX_DAP_MEM_CELLS];
+  int64_t num_readable = num_cells;
+  while (num_readable > 0 &&
+         !read_storage_range(addr, num_readable, values)) {
+    num_readable--;
+  }
+  uint8_t *bytes = malloc(num_readable * sizeof(uint32_t) + 1);
+  for (int64_t i = 0; i < num_readable; i++) {
+    bytes[4 * i] = values[i] >> 24;
+    bytes[4 * i + 1] = values[i] >> 16;
+    bytes[4 * i + 2] = values[i] >> 8;
+    bytes[4 * i + 3] = values[i];
+  }
+  write_addr(body, "address", addr);
+  write_base64(body, "data", bytes, num_readable * sizeof(uint32_t));
+  json_uint(body, "unreadableBytes", (num_cells - num_readable) * 4);
+  free(bytes);
+  return NULL;
+}
+
+// one instruction per address
+static const char *disassemble_cmd(const Json_Value *arguments,
+                                   Json_Writer *body, bool *resume) {
+  int64_t addr, offset = 0, instr_offset = 0, count = 0;
+  if (!parse_memory_reference(arguments, &addr)) {
+    return "Invalid memory reference";
+  }
+  get_num_arg(arguments, "offset", &offset);
+  get_num_arg(arguments, "instructionOffset", &instr_offset);
+  get_num_arg(arguments, "instructionCount", &count);
+  if (count < 0 || count > MAX_DAP_DISASM_INSTRS) {
+    return "Too many instructions";
+  }
+  addr += offset + instr_offset;
+
+  json_begin_array(body, "instructions");
+  for (int64_t i = addr; i < addr + count; i++) {
+    json_begin_object(body, NULL);
+    write_addr(body, "address", i < 0 || i > UINT32_MAX ? 0 : i);
+    if (holds_instr(i)) {
+      uint32_t machine_instr = read_storage_raw(i);
+      char instr_bytes[2 * sizeof(uint32_t) + 1];
+      snprintf(instr_bytes, sizeof(instr_bytes), "%08X", machine_instr);
+      json_str(body, "instructionBytes", instr_bytes);
+      json_str(body, "instruction", cached_assembly_str(i, machine_instr));
+      Program_Type prgrm_type;
+      uint32_t line = line_of_addr(i, &prgrm_type);
+      if (line > 0) {
+        write_source(body, prgrm_type);
+        json_uint(body, "line", line);
+      }
+    } else {
+      json_str(body, "instruction", "??");
+      json_str(body, "presentationHint", "invalid");
+    }
+    json_end_object(body);
+  }
+  json_end_array(body);
+  return NULL;
+}
+
+// the debug console answers the questions for input, otherwise it evaluates
+// the expressions of the conditional breakpoints
+static const char *evaluate_cmd(const Json_Value *arguments, Json_Writer *body,
+                                bool *resume) {
+  const char *expression = json_value_str(json_get(arguments, "expression"));
+  if (!expression) {
+    return "Missing expression";
+  }
+  if (pending_input) {
+    if (strlen(expression) > pending_input_max_len) {
+      return "Input too long";
+    }
+    strcpy(pending_input, expression);
+    json_str(body, "result", expression);
+    *resume = true;
+  } else {
+    Condition expression_code;
+    if (!compile_condition(expression, &expression_code)) {
+      return "Invalid expression, e.g. ACC + 1 or M[DS+5]";
+    }
+    char result[MAX_DIGITS_ADDR_DEC + 2];
+    snprintf(result, sizeof(result), "%d", eval_expression(&expression_code));
+    json_str(body, "result", result);
+  }
+  json_uint(body, "variablesReference", 0);
+  return NULL;
+}
+
+static const char *disconnect_cmd(const Json_Value *arguments,
+                                  Json_Writer *body, bool *resume) {
+  return NULL;
+}
+
+static const Dap_Command commands[] = {
+    {"initialize", false, initialize_cmd},
+    {"launch", false, launch_cmd},
+    {"attach", false, launch_cmd},
+    {"setBreakpoints", false, set_breakpoints_cmd},
+    {"setInstructionBreakpoints", false, set_instr_breakpoints_cmd},
+    {"setExceptionBreakpoints", false, set_exception_breakpoints_cmd},
+    {"configurationDone", true, configuration_done_cmd},
+    {"threads", false, threads_cmd},
+    {"stackTrace", false, stack_trace_cmd},
+    {"scopes", false, scopes_cmd},
+    {"variables", false, variables_cmd},
+    {"setVariable", true, set_variable_cmd},
+    {"continue", true, continue_cmd},
+    {"next", true, next_cmd},
+    {"stepIn", true, step_in_cmd},
+    {"stepOut", true, step_out_cmd},
+    {"stepBack", true, step_back_cmd},
+    {"reverseContinue", true, reverse_continue_cmd},
+    {"restart", true, restart_cmd},
+    {"pause", false, pause_cmd},
+    {"readMemory", false, read_memory_cmd},
+    {"disassemble", false, disassemble_cmd},
+    {"evaluate", false, evaluate_cmd},
+    {"disconnect", false, disconnect_cmd},
+    {"terminate", false, disconnect_cmd},
+};
+
+static const Dap_Command *find_command(const char *command) {
+  for (uint8_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+    if (command && strcmp(command, commands[i].name) == 0) {
+      return &commands[i];
+    }
+  }
+  return NULL;
+}
+
+static const char *dispatch_request(const char *command,
+                                    const Json_Value *arguments,
+                                    Json_Writer *body, bool *resume) {
+  const Dap_Command *dap_command = find_command(command);
+  if (!dap_command) {
+    return "Unsupported request";
+  } else if (dap_command->runs_machine && pending_input) {
+    return "Waiting for input in the debug console";
+  } else if (dap_command->runs_machine && machine_running) {
+    return "Not possible while the program runs, pause it first";
+  }
+  return dap_command->handle(arguments, body, resume);
+}
+
+// returns whether the execution continues, a request can wait for input and
+// so for further requests
+static bool handle_dap_request(Json_Value *request) {
+  const char *command = json_value_str(json_get(request, "command"));
+  int64_t request_seq = 0;
+  get_num_arg(request, "seq", &request_seq);
+  if (!command) {
+    free_json(request);
+    return false;
+  }
+
+  Json_Writer response = {NULL, 0, 0};
+  json_begin_object(&response, NULL);
+  json_uint(&response, "seq", seq++);
+  json_str(&response, "type", "response");
+  json_int(&response, "request_seq", request_seq);
+  json_str(&response, "command", command);
+  size_t len_header = response.len;
+  json_bool(&response, "success", true);
+  json_begin_object(&response, "body");
+
+  bool resume = false;
+  const char *error = dispatch_request(command, json_get(request, "arguments"),
+                                       &response, &resume);
+  if (error) {
+    response.len = len_header;
+    json_bool(&response, "success", false);
+    json_str(&response, "message", error);
+    resume = false;
+  } else {
+    json_end_object(&response);
+  }
+  json_end_object(&response);
+  send_message(&response);
+  fin_json_writer(&response);
+
+  if (pending_events & DAP_EVENT_INITIALIZED) {
+    Json_Writer writer = {NULL, 0, 0};
+    begin_event(&writer, "initialized");
+    send_event(&writer);
+  }
+  if (pending_events & DAP_EVENT_STOPPED) {
+    send_stopped_event();
+  }
+  pending_events = 0;
+
+  bool is_disconnect = strcmp(command, "disconnect") == 0 ||
+                       strcmp(command, "terminate") == 0;
+  free_json(request);
+  if (is_disconnect) {
+    finalize();
+    exit(EXIT_SUCCESS);
+  }
+  return resume;
+}
+
+void evaluate_dap_requests() {
+  machine_running = false;
+  if (pause_requested) {
+    pause_requested = false;
+    stop_reason = "pause";
+  }
+  step_in_requested = false;
+  // the first stop waits for the breakpoints of the editor
+  if (configuration_done) {
+    send_stopped_event();
+  }
+  while (!handle_dap_request(next_dap_message())) {
+  }
+  machine_running = true;
+}
+
+void read_dap_input(char *input, const char *message,
+                    uint8_t max_num_digits) {
+  machine_running = false;
+  pending_input = input;
+  pending_input_max_len = max_num_digits;
+  char output[MAX_LEN_DAP_OUTPUT + 1];
+  snprintf(output, sizeof(output), "%s (enter it in the debug console)\n",
+           message);
+  send_dap_output("console", output);
+  while (!handle_dap_request(next_dap_message())) {
+  }
+  machine_running = true;
+  pending_input = NULL;
+}
+
+// a request that runs the machine stays in the queue if the machine stops
+// before the next instruction anyway
+static Json_Value *poll_dap_message() {
+  pthread_mutex_lock(&queue_mutex);
+  Dap_Message *message = queue_head;
+  if (message && breakpoint_encountered) {
+    const Dap_Command *command =
+        find_command(json_value_str(json_get(message->value, "command")));
+    if (command && command->runs_machine) {
+      message = NULL;
+      atomic_store(&dap_requests_pending, true);
+    }
+  }
+  if (message) {
+    remove_queue_head();
+  }
+  bool closed = !queue_head && input_closed;
+  pthread_mutex_unlock(&queue_mutex);
+
+  if (!message && closed) {
+    finalize();
+    exit(EXIT_SUCCESS);
+  }
+  Json_Value *value = message ? message->value : NULL;
+  free(message);
+  return value;
+}
+
+// called between two instructions, returns whether the editor paused the
+// machine
+bool handle_dap_requests_while_running() {
+  atomic_store(&dap_requests_pending, false);
+  Json_Value *request;
+  while (!pause_requested && (request = poll_dap_message())) {
+    handle_dap_request(request);
+  }
+  return pause_requested;
+}
+
+// decides whether an interrupt of the timer or keyboard is entered
+bool dap_steps_into_isr() { return step_in_requested; }
+
+void dap_watchpoint_hit(const char *message) {
+  stop_reason = "data breakpoint";
+  snprintf(stop_description, sizeof(stop_description), "%s", message);
+}
+
+void fin_dap() {
+  Json_Writer writer = {NULL, 0, 0};
+  begin_event(&writer, "exited");
+  json_uint(&writer, "exitCode", 0);
+  send_event(&writer);
+  begin_event(&writer, "terminated");
+  send_event(&writer);
+}
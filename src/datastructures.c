@@ -1,5 +1,8 @@
 #include "../include/datastructures.h"
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 uint8_t heap_size = 0;
 
@@ -48,3 +51,84 @@ uint8_t pop_highest_prio(uint8_t heap[], uint8_t prio_map[]) {
   heapify_down(0, heap, prio_map);
   return highest_priority_isr;
 }
+
+static void alloc_pc_map(Pc_Map *map, uint32_t capacity) {
+  map->keys = malloc(sizeof(uint32_t) * capacity);
+  map->used = calloc(capacity, sizeof(bool));
+  map->counts = malloc(sizeof(map->counts[0]) * capacity);
+  if (!map->keys || !map->used || !map->counts) {
+    fprintf(stderr, "Error: Failed to allocate memory\n");
+    exit(EXIT_FAILURE);
+  }
+  map->capacity = capacity;
+  map->size = 0;
+}
+
+void init_pc_map(Pc_Map *map) { alloc_pc_map(map, PC_MAP_INITIAL_CAPACITY); }
+
+static uint32_t pc_map_slot(Pc_Map *map, uint32_t pc) {
+  // fibonacci hashing, the capacity is always a power of two
+  uint32_t slot = (pc * 2654435769u) & (map->capacity - 1);
+  while (map->used[slot] && map->keys[slot] != pc) {
+    slot = (slot + 1) & (map->capacity - 1);
+  }
+  return slot;
+}
+
+static void grow_pc_map(Pc_Map *map) {
+  Pc_Map old_map = *map;
+  alloc_pc_map(map, old_map.capacity * 2);
+  for (uint32_t i = 0; i < old_map.capacity; i++) {
+    if (old_map.used[i]) {
+      uint32_t slot = pc_map_slot(map, old_map.keys[i]);
+      map->used[slot] = true;
+      map->keys[slot] = old_map.keys[i];
+      memcpy(map->counts[slot], old_map.counts[i], sizeof(map->counts[0]));
+      map->size++;
+    }
+  }
+  free(old_map.keys);
+  free(old_map.used);
+  free(old_map.counts);
+}
+
+uint64_t *pc_map_counts(Pc_Map *map, uint32_t pc) {
+  uint32_t slot = pc_map_slot(map, pc);
+  if (!map->used[slot]) {
+    if (2 * (map->size + 1) > map->capacity) {
+      grow_pc_map(map);
+      slot = pc_map_slot(map, pc);
+    }
+    map->used[slot] = true;
+    map->keys[slot] = pc;
+    memset(map->counts[slot], 0, sizeof(map->counts[0]));
+    map->size++;
+  }
+  return map->counts[slot];
+}
+
+static Pc_Map *map_to_sort;
+static uint8_t count_idx_to_sort;
+
+static int compare_pcs_by_count(const void *a, const void *b) {
+  uint64_t count_a =
+      pc_map_counts(map_to_sort, *(const uint32_t *)a)[count_idx_to_sort];
+  uint64_t count_b =
+      pc_map_counts(map_to_sort, *(const uint32_t *)b)[count_idx_to_sort];
+  return (count_a < count_b) - (count_a > count_b);
+}
+
+// keys sorted descending by the counter with index count_idx
+uint32_t pc_map_sorted_keys(Pc_Map *map, uint8_t count_idx, uint32_t **keys) {
+  *keys = malloc(sizeof(uint32_t) * (map->size + 1));
+  uint32_t num_keys = 0;
+  for (uint32_t i = 0; i < map->capacity; i++) {
+    if (map->used[i]) {
+      (*keys)[num_keys++] = map->keys[i];
+    }
+  }
+  map_to_sort = map;
+  count_idx_to_sort = count_idx;
+  qsort(*keys, num_keys, sizeof(uint32_t), compare_pcs_by_count);
+  return num_keys;
+}
@@ -1,13 +1,28 @@
 #include "../include/debug.h"
+#include "../include/arena.h"
 #include "../include/assemble.h"
+#include "../include/breakpoints.h"
+#include "../include/dap.h"
+#include "../include/disasm_cache.h"
+#include "../include/gdb_stub.h"
 #include "../include/input_output.h"
 #include "../include/interrupt.h"
+#include "../include/legacy_frame.h"
+#include "../include/live_view.h"
+#include "../include/mem_stats.h"
 #include "../include/parse_args.h"
+#include "../include/protocol.h"
+#include "../include/record.h"
 #include "../include/reti.h"
+#include "../include/run_until.h"
+#include "../include/snapshot.h"
 #include "../include/special_opts.h"
 #include "../include/tui.h"
 #include "../include/uart.h"
+#include "../include/undo.h"
 #include "../include/utils.h"
+#include "../include/watchpoints.h"
+#include <inttypes.h>
 #include <limits.h>
 #include <ncurses.h>
 #include <stdbool.h>
@@ -19,7 +34,8 @@
 #ifdef _WIN32
 #define clrscr() system("cls")
 #else
-#define clrscr() printf("\e[1;1H\e[2J") // clear sequence for ANSI terminals
+#define clrscr()                                                               \
+  legacy_print("\e[1;1H\e[2J") // clear sequence for ANSI terminals
 #endif
 
 const Menu_Entry box_entries[] = {
@@ -96,20 +112,14 @@ char *copy_reg_into_str(char *dest, const uint8_t reg) {
 char *copy_im_into_str(char *dest, const uint32_t im) {
   strcpy(dest, " ");
   if (binary_mode) {
-    sprintf(dest + 1, "%s", int_to_bin_str(im, 22));
+    write_bin_str(dest + 1, im, 22);
   } else {
     sprintf(dest + 1, "%d", im);
   }
   return dest + strlen(dest);
 }
 
-char *assembly_to_str(Instruction *instr) {
-  char *instr_str;
-  if (binary_mode) {
-    instr_str = malloc(39); // STOREIN ACC IN2 22bit\0
-  } else {
-    instr_str = malloc(25); // STOREIN ACC IN2 -2097152\0
-  }
+char *write_assembly_str(char *instr_str, Instruction *instr) {
   instr_str[0] = '\0';
   char *dest = instr_str;
   for (size_t i = 0;
@@ -146,8 +156,16 @@ char *assembly_to_str(Instruction *instr) {
   return instr_str;
 }
 
-char *mem_value_to_str(int32_t mem_content, bool is_unsigned) {
-  char *instr_str = malloc(12); // -2147483649
+char *assembly_to_str(Instruction *instr) {
+  if (binary_mode) {
+    return write_assembly_str(malloc(ASSEMBLY_STR_SIZE), instr);
+  } else {
+    return write_assembly_str(malloc(25), instr); // STOREIN ACC IN2 -2097152\0
+  }
+}
+
+static char *write_mem_value_str(char *instr_str, int32_t mem_content,
+                                 bool is_unsigned) {
   if (is_unsigned) {
     sprintf(instr_str, "%u", mem_content);
   } else {
@@ -156,15 +174,50 @@ char *mem_value_to_str(int32_t mem_content, bool is_unsigned) {
   return instr_str;
 }
 
-char *mem_value_to_bin_str(uint32_t mem_content) {
-  return int_to_bin_str(mem_content, 32);
+char *mem_value_to_str(int32_t mem_content, bool is_unsigned) {
+  // -2147483649\0
+  return write_mem_value_str(malloc(12), mem_content, is_unsigned);
+}
+
+// the strings below only live until the next frame of the Debug TUI
+
+static char *frame_assembly_str(uint32_t machine_instr) {
+  Instruction *instr = machine_to_assembly(machine_instr);
+  char *instr_str = write_assembly_str(frame_alloc(ASSEMBLY_STR_SIZE), instr);
+  free(instr);
+  return instr_str;
+}
+
+static char *frame_mem_value_str(uint32_t mem_content, bool is_unsigned) {
+  if (binary_mode) {
+    return write_bin_str(frame_alloc(33), mem_content, 32);
+  }
+  return write_mem_value_str(frame_alloc(12), mem_content, is_unsigned);
 }
 
-char *reg_to_mem_pntr(uint64_t idx, MemType mem_type) {
-  char *active_regs = "";
-  bool at_least_one_reg = false;
+// while the live view draws, the values come from the snapshot of the emulator
+// instead of from the memory it is changing in the meantime
+static const Live_Snapshot *shown_snapshot = NULL;
+
+static uint32_t shown_reg(uint8_t reg) {
+  return shown_snapshot ? shown_snapshot->regs[reg]
+                        : read_array(regs, reg, false);
+}
+
+static uint8_t shown_uart(uint8_t idx) {
+  return shown_snapshot ? shown_snapshot->uart[idx] : uart[idx];
+}
+
+static uint32_t shown_sram_cell(uint64_t idx) {
+  return shown_snapshot ? snapshot_sram_cell(shown_snapshot, idx)
+                        : read_file(sram, idx);
+}
+
+// bit i set means register i points to the cell idx of the memory mem_type
+uint8_t regs_pointing_to(uint64_t idx, MemType mem_type) {
+  uint8_t regs_mask = 0;
   for (int i = 0; i < NUM_REGISTERS; i++) {
-    uint32_t addr = read_array(regs, i, false);
+    uint32_t addr = shown_reg(i);
     uint8_t addr_mem_type = addr >> 30;
     uint32_t addr_idx;
     if (mem_type == SRAM_C || mem_type == SRAM_D || mem_type == SRAM_S) {
@@ -179,22 +232,53 @@ char *reg_to_mem_pntr(uint64_t idx, MemType mem_type) {
          (addr_mem_type == 0b01 && mem_type == UART) ||
          (addr_mem_type == 0b00 && mem_type == EPROM)) &&
         addr_idx == idx) {
-      active_regs = proper_str_cat(active_regs, " ");
-      active_regs = proper_str_cat(active_regs, register_code_to_name[i]);
-      at_least_one_reg = true;
+      regs_mask |= 1 << i;
     }
   }
-  if (at_least_one_reg) {
-    return proper_str_cat("<-", active_regs);
+  return regs_mask;
+}
+
+char *reg_to_mem_pntr(uint8_t regs_mask) {
+  if (!regs_mask) {
+    return "";
+  }
+  // <- and every register with a space in front
+  char *mem_pntr_str = frame_alloc(3 + NUM_REGISTERS * 4);
+  strcpy(mem_pntr_str, "<-");
+  for (int i = 0; i < NUM_REGISTERS; i++) {
+    if (regs_mask & (1 << i)) {
+      strcat(mem_pntr_str, " ");
+      strcat(mem_pntr_str, register_code_to_name[i]);
+    }
+  }
+  return mem_pntr_str;
+}
+
+static Box *mem_type_to_box(MemType mem_type) {
+  switch (mem_type) {
+  case REGS:
+    return &regs_box;
+  case EPROM:
+    return &eprom_box;
+  case UART:
+    return &uart_box;
+  case SRAM_C:
+    return &sram_c_box;
+  case SRAM_D:
+    return &sram_d_box;
+  case SRAM_S:
+    return &sram_s_box;
+  default:
+    fprintf(stderr, "Error: Invalid memory type\n");
+    exit(EXIT_FAILURE);
   }
-  return "";
 }
 
 void print_formatted_to_stdout_or_box(const char *format, Box *box, ...) {
   va_list args;
   va_start(args, box);
   if (legacy_debug_tui) {
-    vprintf(format, args);
+    legacy_vprint(format, args);
   } else {
     char *final_str = create_formatted_str(format, args);
     write_text_into_box(box, final_str);
@@ -207,30 +291,53 @@ void print_formatted_to_stdout_or_box(const char *format, Box *box, ...) {
 void print_mem_content_with_idx(uint64_t idx, uint32_t mem_content,
                                 bool are_unsigned, bool are_instrs,
                                 MemType mem_type) {
+  uint8_t regs_mask = regs_pointing_to(idx, mem_type);
+  Box *box = legacy_debug_tui ? NULL : mem_type_to_box(mem_type);
+
+  uint8_t heat_level = 0;
+  // the access counters are changed by the emulator during the live view
+  if (heatmap_active && !legacy_debug_tui && !shown_snapshot &&
+      (mem_type == SRAM_C || mem_type == SRAM_D || mem_type == SRAM_S)) {
+    heat_level = heat_level_of_sram_cell(idx);
+  }
+  // breakpoints from the table and watched cells are marked, INT 3 speaks
+  // for itself
+  bool marked = false;
+  uint32_t addr = mem_type == EPROM ? idx : (uint32_t)SRAM_CONST << 30 | idx;
+  if (are_instrs && num_breakpoints > 0) {
+    marked = is_breakpoint(addr);
+  } else if (!are_instrs && mem_type != UART && num_watchpoints > 0) {
+    marked = is_watched(addr);
+  }
+
+  // formatting and disassembling is by far the most expensive part of a
+  // frame, most rows are still on the screen from the last one
+  Row_Key key = {idx, mem_content, regs_mask,
+                 (are_instrs ? ROW_INSTR : 0) |
+                     (are_unsigned ? ROW_UNSIGNED : 0) |
+                     (marked ? ROW_MARKED : 0) |
+                     heat_level << ROW_HEAT_SHIFT,
+                 0};
+  if (box && skip_unchanged_row(box, &key)) {
+    return;
+  }
+  uint8_t first_line = box ? box->line : 0;
+
   char idx_str[20];
   switch (mem_type) {
   case SRAM_C:
   case SRAM_D:
   case SRAM_S:
-    snprintf(
-        idx_str, sizeof(idx_str),
-        proper_str_cat(
-            proper_str_cat("%0", num_digits_for_idx_str(sram_size - 1)), "zu"),
-        idx);
+    snprintf(idx_str, sizeof(idx_str), "%0*zu",
+             num_digits_for_idx(sram_size - 1), idx);
     break;
   case EPROM:
-    snprintf(idx_str, sizeof(idx_str),
-             proper_str_cat(proper_str_cat("%0", num_digits_for_idx_str(
-                                                     num_instrs_start_prgrm)),
-                            "zu"),
-             idx);
+    snprintf(idx_str, sizeof(idx_str), "%0*zu",
+             num_digits_for_idx(num_instrs_start_prgrm), idx);
     break;
   case UART:
-    snprintf(idx_str, sizeof(idx_str),
-             proper_str_cat(proper_str_cat("%0", num_digits_for_idx_str(
-                                                     NUM_UART_ADDRESSES)),
-                            "zu"),
-             idx);
+    snprintf(idx_str, sizeof(idx_str), "%0*zu",
+             num_digits_for_idx(NUM_UART_ADDRESSES), idx);
     break;
   default:
     fprintf(stderr, "Error: Invalid memory type\n");
@@ -238,63 +345,48 @@ void print_mem_content_with_idx(uint64_t idx, uint32_t mem_content,
   }
   const char *mem_content_str;
   if (are_instrs) {
-    mem_content_str = assembly_to_str(machine_to_assembly(mem_content));
+    // the cache belongs to the emulator thread, the live view has its own
+    mem_content_str = shown_snapshot ? frame_assembly_str(mem_content)
+                                     : cached_assembly_str(addr, mem_content);
   } else {
-    if (binary_mode) {
-      mem_content_str = mem_value_to_bin_str(mem_content);
-    } else {
-      mem_content_str = mem_value_to_str(mem_content, are_unsigned);
-    }
+    mem_content_str = frame_mem_value_str(mem_content, are_unsigned);
   }
 
-  char *reg_to_mem_pntr_str = reg_to_mem_pntr(idx, mem_type);
-  Box *box;
-  if (legacy_debug_tui) {
-    box = NULL;
-  } else {
-    switch (mem_type) {
-    case REGS:
-      box = &regs_box;
-      break;
-    case EPROM:
-      box = &eprom_box;
-      break;
-    case UART:
-      box = &uart_box;
-      break;
-    case SRAM_C:
-      box = &sram_c_box;
-      break;
-    case SRAM_D:
-      box = &sram_d_box;
-      break;
-    case SRAM_S:
-      box = &sram_s_box;
-      break;
-    default:
-      fprintf(stderr, "Error: Invalid memory type\n");
-      exit(EXIT_FAILURE);
-    }
-  }
+  char *reg_to_mem_pntr_str = reg_to_mem_pntr(regs_mask);
 
-  print_formatted_to_stdout_or_box("%s: %s%s\n", box, idx_str, mem_content_str,
+  if (heat_level > 0) {
+    wattron(box->win, COLOR_PAIR(heat_level));
+  }
+  print_formatted_to_stdout_or_box("%s%s: %s%s\n", box, idx_str,
+                                   marked ? "*" : "", mem_content_str,
                                    reg_to_mem_pntr_str);
+  if (heat_level > 0) {
+    wattroff(box->win, COLOR_PAIR(heat_level));
+  }
+  if (box) {
+    remember_row(box, &key, first_line);
+  }
 }
 
 void print_reg_content_with_reg(uint8_t reg_idx, uint32_t mem_content) {
+  Row_Key key = {reg_idx, mem_content, 0, 0, 0};
+  if (!legacy_debug_tui && skip_unchanged_row(&regs_box, &key)) {
+    return;
+  }
+  uint8_t first_line = regs_box.line;
+
   char reg_str[4];
   snprintf(reg_str, sizeof(reg_str), "%3s", register_code_to_name[reg_idx]);
-  const char *mem_content_str_unsigned;
-  if (binary_mode) {
-    mem_content_str_unsigned = mem_value_to_bin_str(mem_content);
-  } else {
-    mem_content_str_unsigned = mem_value_to_str(mem_content, true);
-  }
-  const char *mem_content_str_signed = mem_value_to_str(mem_content, false);
+  const char *mem_content_str_unsigned = frame_mem_value_str(mem_content, true);
+  const char *mem_content_str_signed =
+      write_mem_value_str(frame_alloc(12), mem_content, false);
 
   print_formatted_to_stdout_or_box("%s: %s (%s)\n", &regs_box, reg_str,
                                    mem_content_str_unsigned,
                                    mem_content_str_signed);
+  if (!legacy_debug_tui) {
+    remember_row(&regs_box, &key, first_line);
+  }
 }
 
 void print_array_with_idcs(MemType mem_type, uint8_t length, bool are_instrs) {
@@ -306,7 +398,7 @@ void print_array_with_idcs_from_to(MemType mem_type, uint64_t start,
   switch (mem_type) {
   case REGS:
     for (uint8_t i = start; i <= end; i++) {
-      print_reg_content_with_reg(i, ((uint32_t *)regs)[i]);
+      print_reg_content_with_reg(i, shown_reg(i));
     }
     break;
   case EPROM:
@@ -321,8 +413,7 @@ void print_array_with_idcs_from_to(MemType mem_type, uint64_t start,
     break;
   case UART:
     for (uint8_t i = start; i <= end; i++) {
-      print_mem_content_with_idx(i, ((uint8_t *)uart)[i], false, are_instrs,
-                                 UART);
+      print_mem_content_with_idx(i, shown_uart(i), false, are_instrs, UART);
     }
     break;
   default:
@@ -338,8 +429,14 @@ void print_file_with_idcs(MemType mem_type, uint64_t start, uint64_t end,
   case SRAM_D:
   case SRAM_S:
     for (uint64_t i = start; i <= end; i++) {
-      print_mem_content_with_idx(i, read_file(sram, i), are_unsigned,
-                                 are_instrs, mem_type);
+      uint32_t addr = (uint32_t)SRAM_CONST << 30 | i;
+      uint32_t mem_content;
+      if (!are_instrs || shown_snapshot ||
+          !cached_machine_instr(addr, &mem_content)) {
+        mem_content = shown_sram_cell(i);
+      }
+      print_mem_content_with_idx(i, mem_content, are_unsigned, are_instrs,
+                                 mem_type);
     }
     break;
   default:
@@ -350,7 +447,7 @@ void print_file_with_idcs(MemType mem_type, uint64_t start, uint64_t end,
 
 uint64_t determine_watchobject_value(Register watchobject_enum) {
   if (watchobject_enum != ADDRESS) {
-    return read_array(regs, watchobject_enum, false);
+    return shown_reg(watchobject_enum);
   }
 
   char *endptr;
@@ -443,6 +540,13 @@ void print_sram_watchobject(uint64_t sram_watchobject_x, MemType mem_type) {
       ds_vals_unsigned, false);
 }
 
+static void print_live_view_status() {
+  print_formatted_to_stdout_or_box("Running: %" PRIu64 " instructions\n",
+                                   &uart_box,
+                                   shown_snapshot->num_executed_instrs);
+  print_formatted_to_stdout_or_box("Press any key to pause\n", &uart_box);
+}
+
 void print_uart_meta_data() {
   print_formatted_to_stdout_or_box("Current send data: %s\n", &uart_box,
                                    current_send_data ? current_send_data : "");
@@ -491,41 +595,175 @@ void print_uart_meta_data() {
 
 char *watchobject_addr = NULL;
 
+static const Menu_Entry identifier_to_dumped_box[] = {
+    {"R", REGS_BOX},    {"E", EPROM_BOX},   {"U", UART_BOX},
+    {"SC", SRAM_C_BOX}, {"SD", SRAM_D_BOX}, {"SS", SRAM_S_BOX},
+};
+
+// bit i set means the box with the BoxIdentifier i is drawn
+static uint8_t drawn_boxes = ALL_BOXES;
+// the debug script only draws boxes when asked to with d
+static bool dumping = false;
+
+#define is_drawn(box_identifier) (drawn_boxes & (1 << (box_identifier)))
+
+bool dump_boxes(const char *identifier) {
+  uint8_t boxes_to_dump = ALL_BOXES;
+  if (identifier[0] != '\0') {
+    boxes_to_dump = 0;
+    for (uint8_t i = 0; i < NUM_DUMPABLE_BOXES; i++) {
+      if (strcmp(identifier, identifier_to_dumped_box[i].text) == 0) {
+        boxes_to_dump = 1 << identifier_to_dumped_box[i].object;
+      }
+    }
+    if (boxes_to_dump == 0) {
+      return false;
+    }
+  }
+  drawn_boxes = legacy_debug_tui ? boxes_to_dump : ALL_BOXES;
+  dumping = true;
+  draw_tui();
+  dumping = false;
+  drawn_boxes = ALL_BOXES;
+  return true;
+}
+
+// the legacy TUI reads whole lines, so a command can carry its argument on
+// the same line, e.g. n 1000
+static void read_command_args(char *args) {
+  int ch = get_command_char();
+  while (ch == ' ') {
+    ch = get_command_char();
+  }
+  uint8_t len = 0;
+  while (ch != '\n' && ch != EOF) {
+    if (len <= MAX_CHARS_RUN_UNTIL) {
+      args[len++] = ch;
+    }
+    ch = get_command_char();
+  }
+  args[len] = '\0';
+}
+
+// like (c)ontinue a breakpoint directly before is passed, the search ends at
+// the breakpoint before or as far as the undo log reaches
+void step_back_to_breakpoint() {
+  step_back();
+  while (step_back()) {
+    uint32_t pc = read_array(regs, PC, false);
+    Instruction *instr = machine_to_assembly(read_storage_raw(pc));
+    bool breakpoint_reached = (instr->op == INT && instr->opd1 == 3) ||
+                              (num_breakpoints > 0 && breakpoint_hits(pc));
+    free(instr);
+    if (breakpoint_reached) {
+      break;
+    }
+  }
+}
+
+// edits of the registers by a front-end are undone by a step back like an
+// instruction
+void set_registers(const uint32_t *values) {
+  if (memcmp(regs, values, sizeof(uint32_t) * NUM_REGISTERS) == 0) {
+    return;
+  }
+  if (undo_active) {
+    undo_instr_begin();
+  }
+  memcpy(regs, values, sizeof(uint32_t) * NUM_REGISTERS);
+  if (undo_active) {
+    undo_instr_end();
+  }
+}
+
 void evaluate_keyboard_input(void) {
   char key;
+  // whatever the machine stopped for, a pending run until is over
+  run_until_active = false;
+  if (protocol_active) {
+    evaluate_protocol_requests();
+    return;
+  } else if (dap_active) {
+    evaluate_dap_requests();
+    return;
+  } else if (gdb_active) {
+    evaluate_gdb_requests();
+    return;
+  }
   while (true) {
-    if (legacy_debug_tui) {
+    if (legacy_debug_tui && !debug_script_active) {
       printf("Enter a command letter and press enter: ");
     }
-    char ch = getchar();
+    int ch = get_command_char();
     if (ch == EOF) {
+      if (debug_script_active) {
+        finalize();
+        exit(EXIT_SUCCESS);
+      }
       continue;
     }
-    if (legacy_debug_tui) {
-      clear_input_buffer();
+    if (ch == KEY_RESIZE) {
+      update_term_and_box_sizes();
+      draw_tui();
+      continue;
+    }
+    char args[MAX_CHARS_RUN_UNTIL + 2];
+    args[0] = '\0';
+    if (legacy_debug_tui && ch != '\n') {
+      read_command_args(args);
+    }
+    // empty lines and comments only make the debug script readable
+    if (debug_script_active && (ch == '\n' || ch == '#')) {
+      continue;
     }
     key = (char)ch;
     if (key == 'n') {
-      return;
+      if (args[0] == '\0') {
+        return;
+      } else if (parse_num_steps(args)) {
+        breakpoint_encountered = false;
+        return;
+      }
+      display_input_error("Error: Invalid number of steps");
+    } else if (key == 'N') {
+      clear_prompt_line();
+      char input[MAX_CHARS_NUM_STEPS + 2];
+      ask_for_user_input(input, "Enter the number of steps:",
+                         MAX_CHARS_NUM_STEPS);
+      if (parse_num_steps(input)) {
+        breakpoint_encountered = false;
+        return;
+      }
+      display_input_error("Error: Invalid number of steps");
+      draw_tui();
+    } else if (key == 'u') {
+      if (args[0] == '\0') {
+        clear_prompt_line();
+        ask_for_user_input(args, "Enter n steps, p PC, r register, o or i:",
+                           MAX_CHARS_RUN_UNTIL);
+      }
+      if (parse_run_until(args)) {
+        breakpoint_encountered = false;
+        return;
+      }
+      display_input_error("Error: Invalid run until command, e.g. p 42");
+      draw_tui();
     } else if (key == 'c') {
       breakpoint_encountered = false;
+      // the recording only knows the breakpoints as places to stop
+      if (!legacy_debug_tui && !record_active && !replay_active) {
+        start_live_view();
+      }
       return;
+    } else if ((key == 'r' || key == 'b' || key == 'B') &&
+               (record_active || replay_active)) {
+      // the replay only knows the way forward
+      display_input_error("Error: Not possible while recording or replaying");
     } else if (key == 'r') {
-      write_array(regs, PC, 0, false);
-      write_array(regs, IN1, 0, false);
-      write_array(regs, IN2, 0, false);
-      write_array(regs, ACC, 0, false);
-      write_array(regs, SP, 0, false);
-      write_array(regs, BAF, 0, false);
-      write_array(regs, CS, 0, false);
-      write_array(regs, DS, 0, false);
-
-      reset_uart();
-
-      timer_cnt = 0;
+      restart_from_snapshot();
       draw_tui();
     } else if (key == 's') {
-      if (machine_to_assembly(read_storage(read_array(regs, PC, false)))->op !=
+      if (machine_to_assembly(read_storage_raw(read_array(regs, PC, false)))->op !=
           INT) {
         continue;
       }
@@ -542,16 +780,12 @@ void evaluate_keyboard_input(void) {
         return;
       }
     } else if (key == 'a') {
-      if (legacy_debug_tui) {
-        printf("\033[A\033[K");
-      }
+      clear_prompt_line();
 
       BoxIdentifier box_identifier = ask_for_user_decision(
           box_entries, identifier_to_box, NUM_BOX_ENTRIES,
           "Choose a box identifier:", MAX_CHARS_BOX_IDENTIFIER);
-      if (legacy_debug_tui) {
-        printf("\033[A\033[K");
-      }
+      clear_prompt_line();
 
       if (box_identifier == CANCEL) {
         draw_tui();
@@ -610,10 +844,82 @@ void evaluate_keyboard_input(void) {
         display_input_error("Error: Invalid box identifier");
         break;
       }
+    } else if (key == 'b') {
+      clear_prompt_line();
+      char input[MAX_CHARS_NUM_STEPS + 2];
+      ask_for_user_input(input, "Enter the number of steps back:",
+                         MAX_CHARS_NUM_STEPS);
+      char *endptr;
+      uint64_t num_steps = strtoul(input, &endptr, 10);
+      if (endptr == input || *endptr != '\0') {
+        display_input_error("Error: Invalid number of steps");
+      } else if (num_steps > num_undoable_instrs()) {
+        display_input_error("Error: Not that many instructions to undo");
+      } else {
+        for (uint64_t i = 0; i < num_steps; i++) {
+          step_back();
+        }
+      }
+      draw_tui();
+    } else if (key == 'B') {
+      step_back_to_breakpoint();
+      draw_tui();
+    } else if (key == 'k') {
+      clear_prompt_line();
+      char input[MAX_CHARS_BREAKPOINT + 2];
+      ask_for_user_input(input, "Enter an address or l, li or le and a line:",
+                         MAX_CHARS_BREAKPOINT);
+      uint32_t addr = parse_breakpoint_location(input);
+      if (addr == NO_ADDR || !toggle_breakpoint(addr)) {
+        display_input_error("Error: No instruction at this address or line");
+      }
+      draw_tui();
+    } else if (key == 'K') {
+      clear_prompt_line();
+      char location[MAX_CHARS_BREAKPOINT + 2];
+      ask_for_user_input(location,
+                         "Enter an address or l, li or le and a line:",
+                         MAX_CHARS_BREAKPOINT);
+      uint32_t addr = parse_breakpoint_location(location);
+      if (addr == NO_ADDR) {
+        display_input_error("Error: No instruction at this address or line");
+        draw_tui();
+        continue;
+      }
+      clear_prompt_line();
+      char input[MAX_CHARS_CONDITION + 2];
+      ask_for_user_input(input,
+                         "Enter a condition, e.g. ACC < 0 && M[DS+5] == 42:",
+                         MAX_CHARS_CONDITION);
+      Condition condition;
+      if (!compile_condition(input, &condition)) {
+        display_input_error("Error: Invalid condition");
+      } else if (!set_conditional_breakpoint(addr, &condition)) {
+        display_input_error("Error: No instruction at this address or too "
+                            "many conditions");
+      }
+      draw_tui();
+    } else if (key == 'w') {
+      clear_prompt_line();
+      char input[MAX_CHARS_WATCHPOINT + 2];
+      ask_for_user_input(input, "Enter r, w or c and an address or range:",
+                         MAX_CHARS_WATCHPOINT);
+      Watchpoint watchpoint;
+      if (!parse_watchpoint(input, &watchpoint)) {
+        display_input_error("Error: Invalid watchpoint, e.g. rw 2147483848 "
+                            "or c 2147549180-2147549183");
+      } else if (!toggle_watchpoint(&watchpoint)) {
+        display_input_error("Error: Too many watchpoints");
+      }
+      draw_tui();
     } else if (key == 'D') {
 #ifdef __linux__
       __asm__("int3"); // ../.gdbinit
 #endif
+    } else if (key == 'd') {
+      if (!dump_boxes(args)) {
+        display_input_error("Error: Invalid box identifier");
+      }
     } else if (key == 'q') {
       finalize();
       exit(EXIT_SUCCESS);
@@ -634,67 +940,67 @@ void handle_heading(bool legacy_debug_tui, bool simple_debug_tui, Box *box,
                     uint64_t watchobject_int) {
   if (legacy_debug_tui) {
     if (simple_debug_tui) {
-      printf("%s\n", create_heading('-', format_str, LINEWIDTH));
+      legacy_print("%s\n", create_heading('-', format_str, LINEWIDTH));
     } else {
-      printf(format_str, watchobject, watchobject_int);
-      printf("\n");
+      legacy_print(format_str, watchobject, watchobject_int);
+      legacy_print("\n");
     }
   } else {
     if (simple_debug_tui) {
-      box->title = malloc(strlen(format_str) + 1);
-      strcpy(box->title, format_str);
+      box->title = frame_str_copy(format_str);
     } else {
       uint8_t len_title =
           snprintf(NULL, 0, format_str, watchobject, watchobject_int) + 1;
-      box->title = malloc(len_title);
+      box->title = frame_alloc(len_title);
       snprintf(box->title, len_title, format_str, watchobject, watchobject_int);
     }
   }
 }
 
-bool draw_tui(void) {
-  uint64_t eprom_watchobject_int =
-      determine_watchobject_value(eprom_watchobject);
-  uint64_t sram_watchobject_cs_int =
-      determine_watchobject_value(sram_watchobject_cs);
-  uint64_t sram_watchobject_ds_int =
-      determine_watchobject_value(sram_watchobject_ds);
-  uint64_t sram_watchobject_stack_int =
-      determine_watchobject_value(sram_watchobject_stack);
-  if (eprom_watchobject_int == UINT64_MAX ||
-      sram_watchobject_cs_int == UINT64_MAX ||
-      sram_watchobject_ds_int == UINT64_MAX ||
-      sram_watchobject_stack_int == UINT64_MAX) {
-    return false;
-  }
+static void draw_frame(uint64_t eprom_watchobject_int,
+                       uint64_t sram_watchobject_cs_int,
+                       uint64_t sram_watchobject_ds_int,
+                       uint64_t sram_watchobject_stack_int) {
+  // the titles of the last frame are still needed if the validation in
+  // draw_tui shows a notification box, so the reset has to happen only now
+  reset_frame_arena();
 
   if (legacy_debug_tui) {
-    clrscr();
+    // with --legacy-diff only the changed lines overwrite the last frame
+    if (!debug_script_active && !legacy_diff_active) {
+      clrscr();
+    }
   } else {
     for (int i = 0; i < NUM_BOXES; i++) {
-      wclear(boxes[i]->win);
-      reset_box_line(boxes[i]);
-      if (extended_features) {
-        make_unneccessary_spaces_visible(boxes[i]);
-      }
+      prepare_box(boxes[i]);
     }
   }
 
-  handle_heading(legacy_debug_tui, true, &regs_box, "Registers", "", 0);
-  print_array_with_idcs(REGS, NUM_REGISTERS, false);
-
-  if (legacy_debug_tui) {
-    handle_heading(false, true, &eprom_box, "EPROM", "", 0);
+  if (is_drawn(REGS_BOX)) {
+    handle_heading(legacy_debug_tui, true, &regs_box, "Registers", "", 0);
+    print_array_with_idcs(REGS, NUM_REGISTERS, false);
   }
 
-  handle_heading(legacy_debug_tui, false, &eprom_box, "EPROM: %s (%lu)",
-                 register_or_address_to_identifier[eprom_watchobject],
-                 eprom_watchobject_int);
-  print_eprom_watchobject(eprom_watchobject_int);
+  if (is_drawn(EPROM_BOX)) {
+    if (legacy_debug_tui) {
+      handle_heading(false, true, &eprom_box, "EPROM", "", 0);
+    }
+
+    handle_heading(legacy_debug_tui, false, &eprom_box, "EPROM: %s (%lu)",
+                   register_or_address_to_identifier[eprom_watchobject],
+                   eprom_watchobject_int);
+    print_eprom_watchobject(eprom_watchobject_int);
+  }
 
-  handle_heading(legacy_debug_tui, true, &uart_box, "UART", "", 0);
-  print_array_with_idcs(UART, NUM_UART_ADDRESSES, false);
-  print_uart_meta_data();
+  if (is_drawn(UART_BOX)) {
+    handle_heading(legacy_debug_tui, true, &uart_box, "UART", "", 0);
+    print_array_with_idcs(UART, NUM_UART_ADDRESSES, false);
+    if (shown_snapshot) {
+      print_live_view_status();
+    } else {
+      print_uart_meta_data();
+    }
+  }
 
   // the user shouldn't have to calculate the absolute address for the sram
   sram_watchobject_cs_int =
@@ -706,34 +1012,92 @@ bool draw_tui(void) {
   sram_watchobject_stack_int =
       sram_watchobject_stack_int +
       (uint64_t)((sram_watchobject_stack == ADDRESS) ? (uint32_t)(1 << 31) : 0);
-  if (legacy_debug_tui) {
+  if (legacy_debug_tui && (is_drawn(SRAM_C_BOX) || is_drawn(SRAM_D_BOX) ||
+                           is_drawn(SRAM_S_BOX))) {
     handle_heading(false, true, &regs_box, "SRAM", "", 0);
   }
-  handle_heading(legacy_debug_tui, false, &sram_c_box,
-                 "SRAM Codesegment: %s (%lu)",
-                 register_or_address_to_identifier[sram_watchobject_cs],
-                 sram_watchobject_cs_int);
-  print_sram_watchobject(sram_watchobject_cs_int, SRAM_C);
+  if (is_drawn(SRAM_C_BOX)) {
+    handle_heading(legacy_debug_tui, false, &sram_c_box,
+                   "SRAM Codesegment: %s (%lu)",
+                   register_or_address_to_identifier[sram_watchobject_cs],
+                   sram_watchobject_cs_int);
+    print_sram_watchobject(sram_watchobject_cs_int, SRAM_C);
+  }
 
-  handle_heading(legacy_debug_tui, false, &sram_d_box,
-                 "SRAM Datasegment: %s (%lu)",
-                 register_or_address_to_identifier[sram_watchobject_ds],
-                 sram_watchobject_ds_int);
-  print_sram_watchobject(sram_watchobject_ds_int, SRAM_D);
+  if (is_drawn(SRAM_D_BOX)) {
+    handle_heading(legacy_debug_tui, false, &sram_d_box,
+                   "SRAM Datasegment: %s (%lu)",
+                   register_or_address_to_identifier[sram_watchobject_ds],
+                   sram_watchobject_ds_int);
+    print_sram_watchobject(sram_watchobject_ds_int, SRAM_D);
+  }
 
-  handle_heading(legacy_debug_tui, false, &sram_s_box, "SRAM Stack: %s (%lu)",
-                 register_or_address_to_identifier[sram_watchobject_stack],
-                 sram_watchobject_stack_int);
-  print_sram_watchobject(sram_watchobject_stack_int, SRAM_S);
+  if (is_drawn(SRAM_S_BOX)) {
+    handle_heading(legacy_debug_tui, false, &sram_s_box,
+                   "SRAM Stack: %s (%lu)",
+                   register_or_address_to_identifier[sram_watchobject_stack],
+                   sram_watchobject_stack_int);
+    print_sram_watchobject(sram_watchobject_stack_int, SRAM_S);
+  }
 
   if (legacy_debug_tui) {
-    printf("%s\n", create_heading('=', "Possible actions", LINEWIDTH));
-    printf("(n)ext instruction, (c)ontinue to breakpoint, (r)estart, \n");
-    printf("(s)tep into isr, (f)inalize isr, (t)rigger isr, \n");
-    printf("(a)ssign watchobject reg or addr, (q)uit\n");
+    // the list of actions is of no use for a debug script
+    if (!debug_script_active) {
+      legacy_print("%s\n",
+                   create_heading('=', "Possible actions", LINEWIDTH));
+      legacy_print("(n)ext instruction, (c)ontinue to breakpoint, (r)estart, "
+                   "\n");
+      legacy_print("(N) steps, r(u)n until, (s)tep into isr, (f)inalize isr, "
+                   "\n");
+      legacy_print("(t)rigger isr, ");
+      legacy_print("step (b)ack, (B)ack to breakpoint, toggle brea(k)point, "
+                   "\n");
+      legacy_print("conditional brea(K)point, ");
+      legacy_print("(w)atchpoint, (d)ump boxes, \n");
+      legacy_print("(a)ssign watchobject reg or addr, (q)uit\n");
+    }
+    write_legacy_frame();
   } else {
     draw_boxes();
   }
+}
 
+bool draw_tui(void) {
+  // the frames of the live view are drawn by its own thread, all others need
+  // the terminal for themselves
+  stop_live_view();
+
+  uint64_t eprom_watchobject_int =
+      determine_watchobject_value(eprom_watchobject);
+  uint64_t sram_watchobject_cs_int =
+      determine_watchobject_value(sram_watchobject_cs);
+  uint64_t sram_watchobject_ds_int =
+      determine_watchobject_value(sram_watchobject_ds);
+  uint64_t sram_watchobject_stack_int =
+      determine_watchobject_value(sram_watchobject_stack);
+  if (eprom_watchobject_int == UINT64_MAX ||
+      sram_watchobject_cs_int == UINT64_MAX ||
+      sram_watchobject_ds_int == UINT64_MAX ||
+      sram_watchobject_stack_int == UINT64_MAX) {
+    return false;
+  }
+
+  if ((debug_script_active && !dumping) || protocol_active || dap_active ||
+      gdb_active) {
+    return true;
+  }
+
+  draw_frame(eprom_watchobject_int, sram_watchobject_cs_int,
+             sram_watchobject_ds_int, sram_watchobject_stack_int);
   return true;
 }
+
+void draw_live_frame(const Live_Snapshot *snapshot) {
+  shown_snapshot = snapshot;
+  // the watchobjects were already checked by the frame before the (c)ontinue
+  draw_frame(determine_watchobject_value(eprom_watchobject),
+             determine_watchobject_value(sram_watchobject_cs),
+             determine_watchobject_value(sram_watchobject_ds),
+             determine_watchobject_value(sram_watchobject_stack));
+  shown_snapshot = NULL;
+}
@@ -0,0 +1,58 @@
+#include "../include/disasm_cache.h"
+#include "../include/assemble.h"
+#include "../include/debug.h"
+#include "../include/parse_args.h"
+#include <stdlib.h>
+#include <string.h>
+
+// code changes rarely, but the code segment and the EPROM are disassembled
+// again whenever their box is scrolled
+static Disasm_Entry disasm_cache[DISASM_CACHE_SIZE];
+
+static Disasm_Entry *entry_of_addr(uint32_t addr) {
+  return &disasm_cache[addr % DISASM_CACHE_SIZE];
+}
+
+// saves reading the SRAM file for instructions that are already cached
+bool cached_machine_instr(uint32_t addr, uint32_t *machine_instr) {
+  Disasm_Entry *entry = entry_of_addr(addr);
+  if (entry->addr != addr || !(entry->valid & DISASM_WORD)) {
+    return false;
+  }
+  *machine_instr = entry->machine_instr;
+  return true;
+}
+
+// the string stays valid until the next write to addr
+const char *cached_assembly_str(uint32_t addr, uint32_t machine_instr) {
+  Disasm_Entry *entry = entry_of_addr(addr);
+  if (entry->addr != addr || !(entry->valid & DISASM_WORD) ||
+      entry->machine_instr != machine_instr) {
+    entry->addr = addr;
+    entry->machine_instr = machine_instr;
+    entry->valid = DISASM_WORD;
+  }
+  uint8_t rendering = binary_mode ? DISASM_BINARY : DISASM_DECIMAL;
+  char *instr_str = binary_mode ? entry->binary_str : entry->decimal_str;
+  if (!(entry->valid & rendering)) {
+    Instruction *instr = machine_to_assembly(machine_instr);
+    write_assembly_str(instr_str, instr);
+    free(instr);
+    entry->valid |= rendering;
+  }
+  return instr_str;
+}
+
+void invalidate_disasm(uint32_t addr) {
+  Disasm_Entry *entry = entry_of_addr(addr);
+  if (entry->addr == addr) {
+    entry->valid = 0;
+  }
+}
+
+// after the SRAM was replaced as a whole, e.g. by restoring a snapshot
+void clear_disasm_cache() {
+  for (uint32_t i = 0; i < DISASM_CACHE_SIZE; i++) {
+    disasm_cache[i].valid = 0;
+  }
+}
@@ -0,0 +1,520 @@
+#include "../include/gdb_stub.h"
+#include "../include/breakpoints.h"
+#include "../include/debug.h"
+#include "../include/reti.h"
+#include "../include/special_opts.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool gdb_active = false;
+char *gdb_address = "";
+
+#ifdef _WIN32
+void init_gdb_stub() {
+  fprintf(stderr, "Error: The GDB stub isn't supported on Windows\n");
+  exit(EXIT_FAILURE);
+}
+
+void evaluate_gdb_requests() {}
+
+bool gdb_interrupt_requested() { return false; }
+
+void fin_gdb_stub() {}
+#else
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int conn_fd = -1;
+static bool connection_closed = false;
+static bool detached = false;
+// the first stop is asked for by GDB with ?
+static bool running = false;
+static uint8_t stop_signal = GDB_SIGTRAP;
+static uint32_t instrs_since_poll = 0;
+
+static uint8_t recv_buf[GDB_PACKET_SIZE];
+static size_t recv_len = 0;
+static size_t recv_pos = 0;
+
+static int listen_on_port(unsigned long port) {
+  if (port == 0 || port > UINT16_MAX) {
+    fprintf(stderr, "Error: Port must be between 1 and 65535\n");
+    exit(EXIT_FAILURE);
+  }
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  // GDB runs on the same machine, the stub isn't reachable from outside
+  struct sockaddr_in addr = {0};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    perror("Error: Failed to listen on the port for GDB");
+    exit(EXIT_FAILURE);
+  }
+  return fd;
+}
+
+static int listen_on_socket_path(const char *path) {
+  struct sockaddr_un addr = {0};
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Error: Path of the socket for GDB too long\n");
+    exit(EXIT_FAILURE);
+  }
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  // only a socket that was left over by an earlier run is replaced
+  struct stat path_stat;
+  if (stat(path, &path_stat) == 0 && S_ISSOCK(path_stat.st_mode)) {
+    unlink(path);
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    perror("Error: Failed to create the socket for GDB");
+    exit(EXIT_FAILURE);
+  }
+  return fd;
+}
+
+void init_gdb_stub() {
+  char *endptr;
+  unsigned long port = strtoul(gdb_address, &endptr, 10);
+  bool is_port = endptr != gdb_address && *endptr == '\0';
+  int listen_fd =
+      is_port ? listen_on_port(port) : listen_on_socket_path(gdb_address);
+  if (listen(listen_fd, 1) != 0) {
+    perror("Error: Failed to wait for GDB");
+    exit(EXIT_FAILURE);
+  }
+  fprintf(stderr, "Waiting for GDB on %s\n", gdb_address);
+  conn_fd = accept(listen_fd, NULL, NULL);
+  if (conn_fd < 0) {
+    perror("Error: Failed to accept the connection of GDB");
+    exit(EXIT_FAILURE);
+  }
+  close(listen_fd);
+  if (is_port) {
+    // every packet waits for the answer of the other side
+    int no_delay = 1;
+    setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay,
+               sizeof(no_delay));
+  } else {
+    unlink(gdb_address);
+  }
+}
+
+// returns EOF if GDB closed the connection
+static int read_byte() {
+  if (recv_pos == recv_len) {
+    ssize_t len = recv(conn_fd, recv_buf, sizeof(recv_buf), 0);
+    if (len <= 0) {
+      return EOF;
+    }
+    recv_len = len;
+    recv_pos = 0;
+  }
+  return recv_buf[recv_pos++];
+}
+
+static void send_all(const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t sent = send(conn_fd, data, len, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return;
+    }
+    data += sent;
+    len -= sent;
+  }
+}
+
+static void send_packet(const char *data) {
+  uint8_t checksum = 0;
+  for (const char *ch = data; *ch != '\0'; ch++) {
+    checksum += *ch;
+  }
+  char packet[GDB_PACKET_SIZE + 5];
+  int len = snprintf(packet, sizeof(packet), "$%s#%02x", data, checksum);
+  int ack = '-';
+  while (ack == '-') {
+    send_all(packet, len);
+    // a Ctrl-C that crossed the packet is dropped, the machine is stopped
+    // anyway
+    do {
+      ack = read_byte();
+    } while (ack != '+' && ack != '-' && ack != EOF);
+  }
+}
+
+// acknowledges the packet, returns false if GDB closed the connection
+static bool read_packet(char *packet) {
+  while (true) {
+    int ch;
+    do {
+      ch = read_byte();
+      if (ch == EOF) {
+        return false;
+      }
+    } while (ch != '$');
+
+    uint8_t checksum = 0;
+    size_t len = 0;
+    while ((ch = read_byte()) != '#') {
+      if (ch == EOF) {
+        return false;
+      } else if (len < GDB_PACKET_SIZE - 1) {
+        packet[len++] = ch;
+      }
+      checksum += ch;
+    }
+    packet[len] = '\0';
+    char checksum_str[3] = {0};
+    for (uint8_t i = 0; i < 2; i++) {
+      if ((ch = read_byte()) == EOF) {
+        return false;
+      }
+      checksum_str[i] = ch;
+    }
+    if (strtoul(checksum_str, NULL, 16) == checksum) {
+      send_all("+", 1);
+      return true;
+    }
+    send_all("-", 1);
+  }
+}
+
+static bool parse_hex(const char *str, const char **end, uint64_t max,
+                      uint64_t *value) {
+  char *endptr;
+  unsigned long long num = strtoull(str, &endptr, 16);
+  if (endptr == str || num > max) {
+    return false;
+  }
+  *value = num;
+  *end = endptr;
+  return true;
+}
+
+// the byte address of a cell is 4 times its address, an address that isn't
+// the start of a cell can't be a breakpoint or the PC
+static bool parse_cell_addr(const char *str, const char **end,
+                            uint32_t *addr) {
+  uint64_t byte_addr;
+  if (!parse_hex(str, end, MAX_GDB_BYTE_ADDR, &byte_addr) ||
+      byte_addr % 4 != 0) {
+    return false;
+  }
+  *addr = byte_addr / 4;
+  return true;
+}
+
+// the registers and cells are sent big endian like the bits of the
+// instructions
+static bool parse_word(const char *str, uint32_t *value) {
+  char word[9] = {0};
+  for (uint8_t i = 0; i < 8; i++) {
+    if (!strchr("0123456789abcdefABCDEF", str[i]) || str[i] == '\0') {
+      return false;
+    }
+    word[i] = str[i];
+  }
+  *value = strtoul(word, NULL, 16);
+  return true;
+}
+
+static void read_registers(char *reply) {
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    sprintf(reply + 8 * i, "%08x", regs[i]);
+  }
+}
+
+static void write_registers(const char *args, char *reply) {
+  uint32_t values[NUM_REGISTERS];
+  if (strlen(args) != 8 * NUM_REGISTERS) {
+    strcpy(reply, "E01");
+    return;
+  }
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    if (!parse_word(args + 8 * i, &values[i])) {
+      strcpy(reply, "E01");
+      return;
+    }
+  }
+  set_registers(values);
+  strcpy(reply, "OK");
+}
+
+static void read_register(const char *args, char *reply) {
+  uint64_t reg;
+  if (!parse_hex(args, &args, NUM_REGISTERS - 1, &reg)) {
+    strcpy(reply, "E01");
+    return;
+  }
+  sprintf(reply, "%08x", regs[reg]);
+}
+
+static void write_register(const char *args, char *reply) {
+  uint64_t reg;
+  uint32_t values[NUM_REGISTERS];
+  memcpy(values, regs, sizeof(values));
+  if (!parse_hex(args, &args, NUM_REGISTERS - 1, &reg) || *args != '=' ||
+      strlen(args + 1) != 8 || !parse_word(args + 1, &values[reg])) {
+    strcpy(reply, "E01");
+    return;
+  }
+  set_registers(values);
+  strcpy(reply, "OK");
+}
+
+// addresses and lengths count bytes, the cell at an address is at 4 times the
+// address for GDB
+static void read_memory(const char *args, char *reply) {
+  uint64_t byte_addr, len;
+  if (!parse_hex(args, &args, MAX_GDB_BYTE_ADDR, &byte_addr) ||
+      *args != ',' || !parse_hex(args + 1, &args, UINT64_MAX, &len)) {
+    strcpy(reply, "E01");
+    return;
+  }
+  if (len > MAX_GDB_MEM_BYTES) {
+    len = MAX_GDB_MEM_BYTES;
+  }
+  if (len > MAX_GDB_BYTE_ADDR - byte_addr + 1) {
+    len = MAX_GDB_BYTE_ADDR - byte_addr + 1;
+  }
+  uint32_t addr = byte_addr / 4;
+  uint8_t offset = byte_addr % 4;
+  uint32_t count = (offset + len + 3) / 4;
+  // the readable part ends at the end of the memory of the address
+  uint32_t values[MAX_GDB_MEM_CELLS];
+  while (count > 0 && !read_storage_range(addr, count, values)) {
+    count--;
+  }
+  if (count * 4 <= offset) {
+    strcpy(reply, "E01");
+    return;
+  }
+  if (len > count * 4 - offset) {
+    len = count * 4 - offset;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    uint32_t byte = offset + i;
+    sprintf(reply + 2 * i, "%02x",
+            (values[byte / 4] >> (24 - 8 * (byte % 4))) & 0xFF);
+  }
+}
+
+// software and hardware breakpoints are both breakpoints of the debugger
+static void change_breakpoint(const char *args, bool insert, char *reply) {
+  uint32_t addr;
+  if (args[0] != '0' && args[0] != '1') {
+    // watchpoints aren't supported
+    return;
+  }
+  if (args[1] != ',' || !parse_cell_addr(args + 2, &args, &addr)) {
+    strcpy(reply, "E01");
+    return;
+  }
+  if (is_breakpoint(addr) != insert && !toggle_breakpoint(addr)) {
+    strcpy(reply, "E01");
+    return;
+  }
+  strcpy(reply, "OK");
+}
+
+// s and c can continue at another address
+static bool resume_at(const char *args, char *reply) {
+  uint32_t values[NUM_REGISTERS];
+  memcpy(values, regs, sizeof(values));
+  if (*args != '\0') {
+    if (!parse_cell_addr(args, &args, &values[PC])) {
+      strcpy(reply, "E01");
+      return false;
+    }
+    set_registers(values);
+  }
+  return true;
+}
+
+// GDB has no RETI architecture, the description names the registers of g
+static void read_target_description(const char *args, char *reply) {
+  static char target_xml[GDB_TARGET_XML_SIZE];
+  if (target_xml[0] == '\0') {
+    size_t len = sprintf(target_xml, "<?xml version=\"1.0\"?>"
+                                     "<target version=\"1.0\">"
+                                     "<feature name=\"org.reti.core\">");
+    for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+      len += sprintf(target_xml + len,
+                     "<reg name=\"%s\" bitsize=\"32\" type=\"uint32\"/>",
+                     register_code_to_name[i]);
+    }
+    sprintf(target_xml + len, "</feature></target>");
+  }
+  uint64_t offset, len;
+  if (strncmp(args, "target.xml:", 11) != 0 ||
+      !parse_hex(args + 11, &args, UINT64_MAX, &offset) || *args != ',' ||
+      !parse_hex(args + 1, &args, UINT64_MAX, &len)) {
+    strcpy(reply, "E01");
+    return;
+  }
+  size_t xml_len = strlen(target_xml);
+  if (offset > xml_len) {
+    strcpy(reply, "E01");
+    return;
+  }
+  // m means that there is more to read, l that this is the last part
+  if (len > GDB_PACKET_SIZE - 2) {
+    len = GDB_PACKET_SIZE - 2;
+  }
+  reply[0] = offset + len < xml_len ? 'm' : 'l';
+  if (len > xml_len - offset) {
+    len = xml_len - offset;
+  }
+  memcpy(reply + 1, target_xml + offset, len);
+  reply[len + 1] = '\0';
+}
+
+static void query(const char *args, char *reply) {
+  if (strncmp(args, "Supported", 9) == 0) {
+    sprintf(reply, "PacketSize=%x;qXfer:features:read+", GDB_PACKET_SIZE);
+  } else if (strncmp(args, "Xfer:features:read:", 19) == 0) {
+    read_target_description(args + 19, reply);
+  } else if (strcmp(args, "Attached") == 0) {
+    strcpy(reply, "1");
+  } else if (strcmp(args, "C") == 0) {
+    strcpy(reply, "QC1");
+  } else if (strcmp(args, "fThreadInfo") == 0) {
+    strcpy(reply, "m1");
+  } else if (strcmp(args, "sThreadInfo") == 0) {
+    strcpy(reply, "l");
+  }
+}
+
+// returns whether the execution continues, an empty reply means that the
+// packet isn't supported
+static bool handle_packet(const char *packet, char *reply) {
+  const char *args = packet + 1;
+  switch (packet[0]) {
+  case '?':
+    sprintf(reply, "S%02x", stop_signal);
+    return false;
+  case 'g':
+    read_registers(reply);
+    return false;
+  case 'G':
+    write_registers(args, reply);
+    return false;
+  case 'p':
+    read_register(args, reply);
+    return false;
+  case 'P':
+    write_register(args, reply);
+    return false;
+  case 'm':
+    read_memory(args, reply);
+    return false;
+  case 'Z':
+    change_breakpoint(args, true, reply);
+    return false;
+  case 'z':
+    change_breakpoint(args, false, reply);
+    return false;
+  case 's':
+    return resume_at(args, reply);
+  case 'c':
+    if (!resume_at(args, reply)) {
+      return false;
+    }
+    breakpoint_encountered = false;
+    return true;
+  case 'q':
+    query(args, reply);
+    return false;
+  case 'H':
+  case 'T':
+    strcpy(reply, "OK");
+    return false;
+  case 'D':
+    // the program runs to the end without the debugger
+    strcpy(reply, "OK");
+    detached = true;
+    breakpoint_encountered = false;
+    return true;
+  case 'k':
+    connection_closed = true;
+    finalize();
+    exit(EXIT_SUCCESS);
+  default:
+    return false;
+  }
+}
+
+void evaluate_gdb_requests() {
+  if (detached) {
+    breakpoint_encountered = false;
+    return;
+  }
+  if (running) {
+    char stop_reply[4];
+    sprintf(stop_reply, "S%02x", stop_signal);
+    send_packet(stop_reply);
+  }
+  char packet[GDB_PACKET_SIZE];
+  char reply[GDB_PACKET_SIZE];
+  bool resume = false;
+  while (!resume) {
+    if (!read_packet(packet)) {
+      connection_closed = true;
+      finalize();
+      exit(EXIT_SUCCESS);
+    }
+    reply[0] = '\0';
+    resume = handle_packet(packet, reply);
+    if (!resume || reply[0] != '\0') {
+      send_packet(reply);
+    }
+  }
+  if (detached) {
+    close(conn_fd);
+    connection_closed = true;
+  }
+  running = true;
+  stop_signal = GDB_SIGTRAP;
+  instrs_since_poll = 0;
+}
+
+// GDB sends a Ctrl-C without a packet around it to interrupt the machine
+bool gdb_interrupt_requested() {
+  if (++instrs_since_poll < GDB_POLL_INTERVAL || detached) {
+    return false;
+  }
+  instrs_since_poll = 0;
+  struct pollfd poll_fd = {conn_fd, POLLIN, 0};
+  if (recv_pos == recv_len && poll(&poll_fd, 1, 0) <= 0) {
+    return false;
+  }
+  int ch = read_byte();
+  if (ch == GDB_INTERRUPT_CHAR) {
+    stop_signal = GDB_SIGINT;
+    return true;
+  } else if (ch != EOF) {
+    recv_pos--;
+    return false;
+  }
+  // the stop notices that the connection is closed
+  return true;
+}
+
+void fin_gdb_stub() {
+  if (!connection_closed) {
+    send_packet("W00");
+    close(conn_fd);
+  }
+}
+#endif
@@ -1,14 +1,102 @@
 #include "../include/input_output.h"
+#include "../include/dap.h"
 #include "../include/debug.h"
+#include "../include/gdb_stub.h"
+#include "../include/live_view.h"
 #include "../include/parse_args.h"
+#include "../include/protocol.h"
 #include "../include/tui.h"
 #include "../include/utils.h"
 #include <ctype.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+bool debug_script_active = false;
+char *debug_script_path = "";
+
+static FILE *debug_script = NULL;
+static uint32_t debug_script_line = 1;
+
+void init_debug_script() {
+  debug_script = fopen(debug_script_path, "r");
+  if (!debug_script) {
+    fprintf(stderr, "Error: Can't open debug script %s\n", debug_script_path);
+    exit(EXIT_FAILURE);
+  }
+}
+
+// all commands and the inputs they ask for come from the debug script if
+// there is one, so the dispatcher of the legacy TUI doesn't notice the
+// difference
+int get_command_char() {
+  if (!debug_script && !legacy_debug_tui) {
+    // the read restarts after a resize of the terminal, with the timeout
+    // Ncurses still notices it and reports it as KEY_RESIZE
+    int ch;
+    timeout(TUI_RESIZE_POLL_MS);
+    while ((ch = getch()) == ERR) {
+    }
+    timeout(-1);
+    return ch;
+  }
+  int ch = getc(debug_script ? debug_script : stdin);
+  if (ch == '\n') {
+    debug_script_line++;
+  }
+  return ch;
+}
+
+static char *get_command_line(char *input, uint8_t size) {
+  if (!fgets(input, size, debug_script ? debug_script : stdin)) {
+    return NULL;
+  }
+  if (strchr(input, '\n')) {
+    debug_script_line++;
+  }
+  return input;
+}
+
+void clear_prompt_line() {
+  if (legacy_debug_tui && !debug_script_active && !protocol_active &&
+      !dap_active) {
+    printf("\033[A\033[K");
+  }
+}
+
 bool display_notification_box_with_action(const char *title, const char *message, const char key, void (*action)(void), void (*action2)(void)) {
+  if (legacy_debug_tui) {
+    if (action == NULL) {
+      display_error_notification(message);
+      return true;
+    }
+    // the step into of the editor decides, it can't answer questions
+    if (dap_active) {
+      if (dap_steps_into_isr()) {
+        action2();
+        return false;
+      }
+      action();
+      return true;
+    }
+    // GDB can't answer questions, stepping doesn't enter the routine
+    if (gdb_active) {
+      action();
+      return true;
+    }
+    // without windows the decision is read like any other input
+    char input[3];
+    display_input_message(input, message, 1);
+    if (input[0] == key) {
+      action2();
+      return false;
+    }
+    action();
+    return true;
+  }
+
+  stop_live_view();
   const uint8_t LEN_ERROR = strlen(title);
   const uint8_t LEN_PRESS_ENTER = strlen("Press Enter to continue");
   const uint8_t LEN_MESSAGE = strlen(message);
@@ -58,6 +146,10 @@ void display_notification_box(const char *title, const char *message) {
 
 void display_input_box(char *input, const char *message,
                        uint8_t max_num_digits) {
+  // e.g. the program asks for input during (c)ontinue
+  bool live_view_was_active = live_view_active;
+  stop_live_view();
+
   const uint8_t LEN_MESSAGE = strlen(message);
   uint8_t box_width = LEN_MESSAGE + 4; // 2 spaces, 2 corncer chrs
   uint8_t box_height = 3;
@@ -76,6 +168,9 @@ void display_input_box(char *input, const char *message,
   noecho();
 
   delwin(input_box);
+  if (live_view_was_active) {
+    start_live_view();
+  }
 }
 
 uint8_t display_popup_menu(const Menu_Entry entries[], uint8_t num_entries) {
@@ -141,6 +236,30 @@ uint8_t display_popup_menu(const Menu_Entry entries[], uint8_t num_entries) {
 }
 
 void display_error_notification(const char *message) {
+  if (protocol_active) {
+    char line[MAX_LEN_PROTOCOL_MESSAGE + 1];
+    snprintf(line, sizeof(line), "%.*s", (int)strcspn(message, "\n"),
+             message);
+    send_protocol_message("notification", line);
+    return;
+  } else if (dap_active) {
+    char line[MAX_LEN_DAP_OUTPUT + 1];
+    snprintf(line, sizeof(line), "%.*s\n", (int)strcspn(message, "\n"),
+             message);
+    send_dap_output("console", line);
+    return;
+  }
+  if (gdb_active) {
+    // nobody presses Enter while GDB is debugging
+    fprintf(stderr, "%s\n", message);
+    return;
+  }
+  if (debug_script_active) {
+    // the line of the command that caused the error, not of the next one
+    fprintf(stderr, "%.*s in line %u of the debug script\n",
+            (int)strcspn(message, "\n"), message, debug_script_line - 1);
+    return;
+  }
   fprintf(stderr, "%s\n", message);
   printf("Press Enter to continue");
   // wait until the Enter key is pressed
@@ -152,9 +271,22 @@ void display_error_notification(const char *message) {
 
 void display_input_message(char *input, const char *message,
                            uint8_t max_num_digits) {
+  if (protocol_active) {
+    read_protocol_input(input, message, max_num_digits);
+    return;
+  } else if (dap_active) {
+    read_dap_input(input, message, max_num_digits);
+    return;
+  }
   while (true) {
-    printf("%s ", message);
-    if (fgets((char *)input, max_num_digits + 2, stdin) == NULL) {
+    if (!debug_script_active) {
+      printf("%s ", message);
+    }
+    if (get_command_line(input, max_num_digits + 2) == NULL) {
+      if (debug_script_active) {
+        fprintf(stderr, "Error: Debug script ended while waiting for input\n");
+        exit(EXIT_FAILURE);
+      }
       fprintf(stderr, "Error: Couldn't read input\n");
     } else {
       // Find the position of the newline character
@@ -163,8 +295,8 @@ void display_input_message(char *input, const char *message,
       // long
       if (input[idx_of_newline] != '\n') {
         // Clear the input buffer
-        uint32_t c;
-        while ((c = getchar()) != '\n' && c != EOF)
+        int c;
+        while ((c = get_command_char()) != '\n' && c != EOF)
           ;
         display_error_notification("Error: Input too long\n");
       } else {
@@ -1,19 +1,35 @@
 #include "../include/interpr.h"
 #include "../include/assemble.h"
+#include "../include/branch_pred.h"
+#include "../include/breakpoints.h"
+#include "../include/dap.h"
 #include "../include/datastructures.h"
 #include "../include/debug.h"
 #include "../include/error.h"
+#include "../include/gdb_stub.h"
 #include "../include/interrupt.h"
 #include "../include/interrupt_controller.h"
+#include "../include/live_view.h"
 #include "../include/parse_args.h"
+#include "../include/pipeline.h"
+#include "../include/record.h"
 #include "../include/reti.h"
+#include "../include/run_until.h"
+#include "../include/shm_export.h"
+#include "../include/timing.h"
+#include "../include/trace.h"
 #include "../include/uart.h"
+#include "../include/undo.h"
 #include "../include/utils.h"
+#include "../include/watchpoints.h"
 #include <ncurses.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
 uint8_t current_isr;
+uint32_t instr_pc;
+uint64_t num_executed_instrs = 0;
+uint64_t num_isr_returns = 0;
 
 void restore_state() {
   isr_active = restore_isr_active;
@@ -34,6 +50,37 @@ static void return_from_interrupt() {
   write_array(regs, SP, read_array(regs, SP, false) + 1, false);
 }
 
+// the JUMP family except JUMP itself
+bool jump_condition_holds(uint8_t op, int32_t acc) {
+  switch (op) {
+  case JUMPGT:
+    return acc > 0;
+  case JUMPEQ:
+    return acc == 0;
+  case JUMPGE:
+    return acc >= 0;
+  case JUMPLT:
+    return acc < 0;
+  case JUMPNE:
+    return acc != 0;
+  case JUMPLE:
+    return acc <= 0;
+  default:
+    return false;
+  }
+}
+
+// returns whether the jump was taken
+static bool conditional_jump(bool taken, int32_t offset) {
+  if (branch_pred_active) {
+    record_branch(read_array(regs, PC, false), offset, taken);
+  }
+  if (taken) {
+    write_array(regs, PC, read_array(regs, PC, false) + offset, false);
+  }
+  return taken;
+}
+
 // TODO: Problem, dass immediates sign extended werden, aber bitweise xor, and
 // und or auf das nicht sign extendete mit 0en drangefügt angewandt werden
 // TODO: Alernative Lösung ohne sign extension mit:
@@ -330,6 +377,7 @@ void interpr_instr(Instruction *assembly_instr) {
     goto no_pc_increase;
     break;
   case RTI:
+    num_isr_returns++;
     return_from_interrupt();
     if (stack_top > -1) { // means a hardware interupt is active
       keypress_interrupt_active = false;
@@ -364,50 +412,14 @@ void interpr_instr(Instruction *assembly_instr) {
     }
     break;
   case JUMPGT:
-    if ((int32_t)read_array(regs, ACC, false) > 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
-      goto no_pc_increase;
-    }
-    break;
   case JUMPEQ:
-    if (read_array(regs, ACC, false) == 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
-      goto no_pc_increase;
-    }
-    break;
   case JUMPGE:
-    if ((int32_t)read_array(regs, ACC, false) >= 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
-      goto no_pc_increase;
-    }
-    break;
   case JUMPLT:
-    if ((int32_t)read_array(regs, ACC, false) < 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
-      goto no_pc_increase;
-    }
-    break;
   case JUMPNE:
-    if (read_array(regs, ACC, false) != 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
-      goto no_pc_increase;
-    }
-    break;
   case JUMPLE:
-    if ((int32_t)read_array(regs, ACC, false) <= 0) {
-      write_array(regs, PC,
-                  read_array(regs, PC, false) + (int32_t)assembly_instr->opd1,
-                  false);
+    if (conditional_jump(jump_condition_holds(assembly_instr->op,
+                                              read_array(regs, ACC, false)),
+                         assembly_instr->opd1)) {
       goto no_pc_increase;
     }
     break;
@@ -427,28 +439,103 @@ no_pc_increase:;
 
 void interpr_prgrm() {
   while (true) {
+    // during (c)ontinue this bit test is all the debugger does
+    if (num_breakpoints > 0 && breakpoint_hits(regs[PC])) {
+      breakpoint_encountered = true;
+    }
+    // a pause of the editor or a Ctrl-C of GDB stops like a breakpoint, the
+    // other requests of the editor are answered in between
+    if ((dap_active && dap_requests_pending &&
+         handle_dap_requests_while_running()) ||
+        (gdb_active && gdb_interrupt_requested())) {
+      breakpoint_encountered = true;
+    }
+    if (run_until_active) {
+      check_run_until();
+    }
+    if (live_view_active) {
+      check_live_view();
+    }
+    if (shm_export_active) {
+      check_shm_export();
+    }
     if (visibility_condition) {
-      update_term_and_box_sizes();
+      if (!legacy_debug_tui) {
+        update_layout_if_resized();
+      }
+      // a viewer shows where the machine stopped, not where it was up to
+      // SHM_UPDATE_INTERVAL instructions ago
+      if (shm_export_active) {
+        publish_shm_state();
+      }
       draw_tui();
+      if (watchpoint_hit) {
+        show_watchpoint_hit();
+      }
       evaluate_keyboard_input();
     }
 
-    uint32_t machine_instr = read_storage(read_array(regs, PC, false));
+    if (replay_active) {
+      replay_keypresses();
+    }
+    if (undo_active) {
+      undo_instr_begin();
+    }
+    if (timing_active) {
+      timing_instr_begin();
+    }
+    uint32_t pc = read_array(regs, PC, false);
+    instr_pc = pc;
+    uint32_t machine_instr = fetch_instr(pc);
     Instruction *assembly_instr = machine_to_assembly(machine_instr);
+    if (trace_active) {
+      trace_instr_begin(pc, machine_instr);
+    }
 
     if (assembly_instr->op == JUMP && assembly_instr->opd1 == 0) {
+      if (timing_active) {
+        timing_instr_end(JUMP);
+      }
+      if (pipeline_active) {
+        pipeline_instr(pc, assembly_instr);
+      }
       free(assembly_instr);
+      if (trace_active) {
+        trace_instr_end();
+      }
       break;
     } else if (assembly_instr->op == INT && assembly_instr->opd1 == 3) {
       breakpoint_encountered = true;
       write_array(regs, PC, read_array(regs, PC, false) + 1, false);
+      if (timing_active) {
+        timing_instr_end(INT);
+      }
+      if (pipeline_active) {
+        pipeline_instr(pc, assembly_instr);
+      }
+      free(assembly_instr);
     } else {
       interpr_instr(assembly_instr);
+      if (timing_active) {
+        timing_instr_end(assembly_instr->op);
+      }
+      if (pipeline_active) {
+        pipeline_instr(pc, assembly_instr);
+      }
       free(assembly_instr);
     }
 
     timer_interrupt_check();
     uart_receive();
     uart_send();
+
+    // counted before the end of the step, so that a step back undoes it
+    num_executed_instrs++;
+    if (undo_active) {
+      undo_instr_end();
+    }
+    if (trace_active) {
+      trace_instr_end();
+    }
   }
 }
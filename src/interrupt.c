@@ -3,7 +3,10 @@
 #include "../include/interpr.h"
 #include "../include/interrupt_controller.h"
 #include "../include/parse_args.h"
+#include "../include/record.h"
 #include "../include/reti.h"
+#include "../include/timing.h"
+#include "../include/undo.h"
 #include <stdint.h>
 
 uint32_t timer_cnt = 0;
@@ -31,14 +34,15 @@ void timer_interrupt_check() {
   if (!interrupt_timer_active) {
     return;
   }
-  timer_cnt++;
-  if (timer_cnt == interrupt_timer_interval) {
+  // with the timing model the timer counts cycles instead of instructions
+  timer_cnt += elapsed_ticks();
+  if (interrupt_timer_interval > 0 && timer_cnt >= interrupt_timer_interval) {
     if (handle_hardware_interrupt(INTERRUPT_TIMER - START_DEVICES)) {
       interrupt_timer_active = false;
       save_state();
       uint8_t isr = device_to_isr[INTERRUPT_TIMER - START_DEVICES];
       current_isr = isr;
-      if (debug_mode) {
+      if (visibility_condition) {
         draw_tui();
       }
 
@@ -69,6 +73,12 @@ bool keypress_interrupt_trigger() {
     }
     return false;
   }
+  record_keypress();
+  // the trigger happens between two instructions, so step back undoes it as a
+  // step of its own instead of with the next instruction
+  if (undo_active) {
+    undo_instr_begin();
+  }
   bool should_cont = false;
   if (handle_hardware_interrupt(KEYPRESS - START_DEVICES)) {
     keypress_interrupt_active = true;
@@ -82,10 +92,17 @@ bool keypress_interrupt_trigger() {
     }
     write_array(regs, PC, read_array(regs, PC, false) - 1, false);
     setup_interrupt(isr);
+    if (undo_active) {
+      undo_instr_end();
+    }
     if (step_into_activated) {
       draw_tui();
     }
   } else {
+    // the interrupt may still be queued
+    if (undo_active) {
+      undo_instr_end();
+    }
     display_notification_box("Error", "Keyboard Interrupt has lower priority "
                                       "than current hardware interrupt");
   }
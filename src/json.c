@@ -0,0 +1,412 @@
+#include "../include/json.h"
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *skip_whitespace(const char *str) {
+  while (*str == ' ' || *str == '\t' || *str == '\n' || *str == '\r') {
+    str++;
+  }
+  return str;
+}
+
+// \u escapes are only supported for the ASCII range, the protocol doesn't
+// need more
+static const char *parse_string(const char *str, char *dest, size_t max_len) {
+  if (*str != '"') {
+    return NULL;
+  }
+  str++;
+  size_t len = 0;
+  while (*str != '"') {
+    char ch = *str++;
+    if (ch == '\0' || (unsigned char)ch < 0x20) {
+      return NULL;
+    }
+    if (ch == '\\') {
+      switch (*str++) {
+      case '"':
+        ch = '"';
+        break;
+      case '\\':
+        ch = '\\';
+        break;
+      case '/':
+        ch = '/';
+        break;
+      case 'b':
+        ch = '\b';
+        break;
+      case 'f':
+        ch = '\f';
+        break;
+      case 'n':
+        ch = '\n';
+        break;
+      case 'r':
+        ch = '\r';
+        break;
+      case 't':
+        ch = '\t';
+        break;
+      case 'u': {
+        char hex[5] = {0};
+        for (uint8_t i = 0; i < 4; i++) {
+          if (!isxdigit((unsigned char)str[i])) {
+            return NULL;
+          }
+          hex[i] = str[i];
+        }
+        long code = strtol(hex, NULL, 16);
+        if (code == 0 || code > 0x7F) {
+          return NULL;
+        }
+        ch = code;
+        str += 4;
+        break;
+      }
+      default:
+        return NULL;
+      }
+    }
+    if (len == max_len) {
+      return NULL;
+    }
+    dest[len++] = ch;
+  }
+  dest[len] = '\0';
+  return str + 1;
+}
+
+static const char *parse_value(const char *str, Json_Member *member) {
+  if (*str == '"') {
+    member->type = JSON_STRING;
+    return parse_string(str, member->str, MAX_LEN_JSON_STR);
+  } else if (strncmp(str, "true", 4) == 0) {
+    member->type = JSON_BOOL;
+    member->num = true;
+    return str + 4;
+  } else if (strncmp(str, "false", 5) == 0) {
+    member->type = JSON_BOOL;
+    member->num = false;
+    return str + 5;
+  } else if (strncmp(str, "null", 4) == 0) {
+    member->type = JSON_NULL;
+    return str + 4;
+  } else if (*str == '-' || isdigit((unsigned char)*str)) {
+    // only integers, addresses and counts have no fractional part
+    char *endptr;
+    errno = 0;
+    member->type = JSON_NUMBER;
+    member->num = strtoll(str, &endptr, 10);
+    if (errno == ERANGE || *endptr == '.' || *endptr == 'e' ||
+        *endptr == 'E') {
+      return NULL;
+    }
+    return endptr;
+  }
+  // nested objects and arrays
+  return NULL;
+}
+
+bool parse_json_object(const char *str, Json_Object *object) {
+  object->num_members = 0;
+  str = skip_whitespace(str);
+  if (*str != '{') {
+    return false;
+  }
+  str = skip_whitespace(str + 1);
+  if (*str != '}') {
+    while (true) {
+      if (object->num_members == MAX_JSON_MEMBERS) {
+        return false;
+      }
+      Json_Member *member = &object->members[object->num_members];
+      str = parse_string(str, member->key, MAX_LEN_JSON_KEY);
+      if (!str) {
+        return false;
+      }
+      str = skip_whitespace(str);
+      if (*str != ':') {
+        return false;
+      }
+      str = parse_value(skip_whitespace(str + 1), member);
+      if (!str) {
+        return false;
+      }
+      object->num_members++;
+      str = skip_whitespace(str);
+      if (*str == '}') {
+        break;
+      } else if (*str != ',') {
+        return false;
+      }
+      str = skip_whitespace(str + 1);
+    }
+  }
+  return *skip_whitespace(str + 1) == '\0';
+}
+
+const Json_Member *json_member(const Json_Object *object, const char *key) {
+  for (uint8_t i = 0; i < object->num_members; i++) {
+    if (strcmp(object->members[i].key, key) == 0) {
+      return &object->members[i];
+    }
+  }
+  return NULL;
+}
+
+const char *json_get_str(const Json_Object *object, const char *key) {
+  const Json_Member *member = json_member(object, key);
+  if (!member || member->type != JSON_STRING) {
+    return NULL;
+  }
+  return member->str;
+}
+
+bool json_get_num(const Json_Object *object, const char *key, int64_t *value) {
+  const Json_Member *member = json_member(object, key);
+  if (!member || member->type != JSON_NUMBER) {
+    return false;
+  }
+  *value = member->num;
+  return true;
+}
+
+// the whole string is decoded into memory of its own
+static const char *parse_alloc_string(const char *str, char **dest) {
+  const char *end = str + 1;
+  while (*end != '"' && *end != '\0') {
+    if (*end == '\\' && end[1] != '\0') {
+      end++;
+    }
+    end++;
+  }
+  size_t max_len = end - str;
+  *dest = malloc(max_len + 1);
+  return parse_string(str, *dest, max_len);
+}
+
+static const char *parse_tree_value(const char *str, Json_Value *value,
+                                    uint8_t depth);
+
+// the members of objects and the elements of arrays
+static const char *parse_children(const char *str, Json_Value *value,
+                                  uint8_t depth) {
+  bool is_object = value->type == JSON_OBJECT;
+  char closing = is_object ? '}' : ']';
+  str = skip_whitespace(str + 1);
+  if (*str == closing) {
+    return str + 1;
+  }
+  while (true) {
+    value->children = realloc(value->children, sizeof(Json_Value) *
+                                                   (value->num_children + 1));
+    Json_Value *child = &value->children[value->num_children++];
+    memset(child, 0, sizeof(Json_Value));
+    if (is_object) {
+      str = parse_alloc_string(str, &child->key);
+      if (!str) {
+        return NULL;
+      }
+      str = skip_whitespace(str);
+      if (*str != ':') {
+        return NULL;
+      }
+      str = skip_whitespace(str + 1);
+    }
+    str = parse_tree_value(str, child, depth + 1);
+    if (!str) {
+      return NULL;
+    }
+    str = skip_whitespace(str);
+    if (*str == closing) {
+      return str + 1;
+    } else if (*str != ',') {
+      return NULL;
+    }
+    str = skip_whitespace(str + 1);
+  }
+}
+
+static const char *parse_tree_value(const char *str, Json_Value *value,
+                                    uint8_t depth) {
+  if (depth == MAX_JSON_DEPTH) {
+    return NULL;
+  }
+  if (*str == '{' || *str == '[') {
+    value->type = *str == '{' ? JSON_OBJECT : JSON_ARRAY;
+    return parse_children(str, value, depth);
+  } else if (*str == '"') {
+    value->type = JSON_STRING;
+    return parse_alloc_string(str, &value->str);
+  } else if (*str == '-' || isdigit((unsigned char)*str)) {
+    char *endptr;
+    value->type = JSON_NUMBER;
+    value->num = strtod(str, &endptr);
+    return endptr == str ? NULL : endptr;
+  }
+  Json_Member member;
+  str = parse_value(str, &member);
+  value->type = member.type;
+  value->num = member.num;
+  return str;
+}
+
+// returns NULL if it isn't valid JSON
+Json_Value *parse_json(const char *str) {
+  Json_Value *value = calloc(1, sizeof(Json_Value));
+  str = parse_tree_value(skip_whitespace(str), value, 0);
+  if (!str || *skip_whitespace(str) != '\0') {
+    free_json(value);
+    return NULL;
+  }
+  return value;
+}
+
+const Json_Value *json_get(const Json_Value *object, const char *key) {
+  if (!object || object->type != JSON_OBJECT) {
+    return NULL;
+  }
+  for (uint32_t i = 0; i < object->num_children; i++) {
+    if (strcmp(object->children[i].key, key) == 0) {
+      return &object->children[i];
+    }
+  }
+  return NULL;
+}
+
+const char *json_value_str(const Json_Value *value) {
+  return value && value->type == JSON_STRING ? value->str : NULL;
+}
+
+bool json_value_num(const Json_Value *value, int64_t *num) {
+  if (!value || value->type != JSON_NUMBER) {
+    return false;
+  }
+  *num = value->num;
+  return true;
+}
+
+static void free_json_children(Json_Value *value) {
+  for (uint32_t i = 0; i < value->num_children; i++) {
+    free_json_children(&value->children[i]);
+  }
+  free(value->children);
+  free(value->str);
+  free(value->key);
+}
+
+void free_json(Json_Value *value) {
+  if (value) {
+    free_json_children(value);
+    free(value);
+  }
+}
+
+static void json_append(Json_Writer *writer, const char *format, ...) {
+  va_list args;
+  while (true) {
+    size_t available = writer->size - writer->len;
+    va_start(args, format);
+    int len = vsnprintf(writer->data + writer->len, available, format, args);
+    va_end(args);
+    if ((size_t)len < available) {
+      writer->len += len;
+      return;
+    }
+    writer->size = writer->size ? 2 * writer->size + len : 256 + len;
+    writer->data = realloc(writer->data, writer->size);
+    if (!writer->data) {
+      fprintf(stderr, "Error: Failed to allocate the JSON output\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+// separates a member or element from the one before and writes the key
+static void json_begin_value(Json_Writer *writer, const char *key) {
+  if (writer->len > 0 && writer->data[writer->len - 1] != '{' &&
+      writer->data[writer->len - 1] != '[') {
+    json_append(writer, ",");
+  }
+  if (key) {
+    json_append(writer, "\"%s\":", key);
+  }
+}
+
+void json_reset(Json_Writer *writer) { writer->len = 0; }
+
+void json_begin_object(Json_Writer *writer, const char *key) {
+  json_begin_value(writer, key);
+  json_append(writer, "{");
+}
+
+void json_end_object(Json_Writer *writer) { json_append(writer, "}"); }
+
+void json_begin_array(Json_Writer *writer, const char *key) {
+  json_begin_value(writer, key);
+  json_append(writer, "[");
+}
+
+void json_end_array(Json_Writer *writer) { json_append(writer, "]"); }
+
+void json_int(Json_Writer *writer, const char *key, int64_t value) {
+  json_begin_value(writer, key);
+  json_append(writer, "%" PRId64, value);
+}
+
+void json_uint(Json_Writer *writer, const char *key, uint64_t value) {
+  json_begin_value(writer, key);
+  json_append(writer, "%" PRIu64, value);
+}
+
+void json_bool(Json_Writer *writer, const char *key, bool value) {
+  json_begin_value(writer, key);
+  json_append(writer, value ? "true" : "false");
+}
+
+void json_str(Json_Writer *writer, const char *key, const char *value) {
+  json_begin_value(writer, key);
+  json_append(writer, "\"");
+  for (const char *ch = value; *ch != '\0'; ch++) {
+    switch (*ch) {
+    case '"':
+      json_append(writer, "\\\"");
+      break;
+    case '\\':
+      json_append(writer, "\\\\");
+      break;
+    case '\n':
+      json_append(writer, "\\n");
+      break;
+    case '\t':
+      json_append(writer, "\\t");
+      break;
+    default:
+      if ((unsigned char)*ch < 0x20) {
+        json_append(writer, "\\u%04x", *ch);
+      } else {
+        json_append(writer, "%c", *ch);
+      }
+    }
+  }
+  json_append(writer, "\"");
+}
+
+void json_null(Json_Writer *writer, const char *key) {
+  json_begin_value(writer, key);
+  json_append(writer, "null");
+}
+
+void fin_json_writer(Json_Writer *writer) {
+  free(writer->data);
+  writer->data = NULL;
+  writer->len = 0;
+  writer->size = 0;
+}
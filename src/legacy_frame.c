@@ -0,0 +1,98 @@
+#include "../include/legacy_frame.h"
+#include "../include/input_output.h"
+#include "../include/parse_args.h"
+#include "../include/utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the legacy TUI composes a whole frame and writes it at once, terminals and
+// CI logs are a lot slower with hundreds of small writes
+static Frame_Buffer frame, last_frame, diff;
+
+static void buffer_vprint(Frame_Buffer *buffer, const char *format,
+                          va_list args) {
+  va_list args_copy;
+  va_copy(args_copy, args);
+  int len = vsnprintf(buffer->data + buffer->len, buffer->size - buffer->len,
+                      format, args_copy);
+  va_end(args_copy);
+  if (buffer->len + len >= buffer->size) {
+    buffer->size =
+        max(2 * buffer->size, buffer->len + len + INITIAL_BUFFER_SIZE);
+    buffer->data = realloc(buffer->data, buffer->size);
+    if (!buffer->data) {
+      fprintf(stderr, "Error: Failed to allocate the frame buffer\n");
+      exit(EXIT_FAILURE);
+    }
+    vsnprintf(buffer->data + buffer->len, buffer->size - buffer->len, format,
+              args);
+  }
+  buffer->len += len;
+}
+
+static void buffer_print(Frame_Buffer *buffer, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  buffer_vprint(buffer, format, args);
+  va_end(args);
+}
+
+void legacy_vprint(const char *format, va_list args) {
+  buffer_vprint(&frame, format, args);
+}
+
+void legacy_print(const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  buffer_vprint(&frame, format, args);
+  va_end(args);
+}
+
+static size_t line_len(const char *line, const char *end) {
+  const char *newline = memchr(line, '\n', end - line);
+  return newline ? newline - line : end - line;
+}
+
+// only the lines that differ from the last frame are written over it, this
+// needs the terminal to be high enough that the frame doesn't scroll
+static void compose_diff() {
+  diff.len = 0;
+  if (last_frame.len == 0) {
+    buffer_print(&diff, "\033[1;1H\033[2J");
+  }
+  const char *line = frame.data, *end = frame.data + frame.len;
+  const char *last_line = last_frame.data;
+  const char *last_end = last_frame.data + last_frame.len;
+  uint32_t row = 1;
+  for (; line < end; row++) {
+    size_t len = line_len(line, end);
+    size_t last_len = last_line < last_end ? line_len(last_line, last_end) : 0;
+    if (last_line >= last_end || len != last_len ||
+        memcmp(line, last_line, len) != 0) {
+      buffer_print(&diff, "\033[%u;1H%.*s\033[K", row, (int)len, line);
+    }
+    line += len + 1;
+    if (last_line < last_end) {
+      last_line += last_len + 1;
+    }
+  }
+  // the prompt, the command and messages below the last frame go away
+  buffer_print(&diff, "\033[%u;1H\033[J", row);
+}
+
+void write_legacy_frame() {
+  if (legacy_diff_active && !debug_script_active) {
+    compose_diff();
+    fwrite(diff.data, 1, diff.len, stdout);
+  } else {
+    fwrite(frame.data, 1, frame.len, stdout);
+  }
+  fflush(stdout);
+
+  Frame_Buffer written = last_frame;
+  last_frame = frame;
+  frame = written;
+  frame.len = 0;
+}
@@ -0,0 +1,113 @@
+#include "../include/live_view.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/tui.h"
+#include "../include/uart.h"
+#include "../include/utils.h"
+#include <ncurses.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool live_view_active = false;
+
+static pthread_t live_view_thread;
+static atomic_bool live_view_stopping;
+static atomic_uint live_view_events;
+
+// the emulator fills the snapshot that is not published, the UI thread only
+// asks for the next one after it is done with drawing the published one
+static Live_Snapshot snapshots[2];
+static atomic_uint published_snapshot;
+
+static void fill_sram_window(Sram_Window *window, Register watchobject) {
+  uint64_t center;
+  if (watchobject == ADDRESS) {
+    center = strtoul(watchobject_addr, NULL, 10);
+  } else {
+    center = regs[watchobject] & 0x7FFFFFFF;
+  }
+  window->start = max(0, (int64_t)center - LIVE_VIEW_WINDOW_RADIUS);
+  uint64_t end = min(center + LIVE_VIEW_WINDOW_RADIUS, sram_size - 1);
+  window->len = window->start <= end ? end - window->start + 1 : 0;
+  read_file_range(sram, window->start, window->cells, window->len);
+}
+
+static void fill_live_snapshot(Live_Snapshot *snapshot) {
+  memcpy(snapshot->regs, regs, sizeof(snapshot->regs));
+  memcpy(snapshot->uart, uart, sizeof(snapshot->uart));
+  snapshot->num_executed_instrs = num_executed_instrs;
+  fill_sram_window(&snapshot->sram_windows[0], sram_watchobject_cs);
+  fill_sram_window(&snapshot->sram_windows[1], sram_watchobject_ds);
+  fill_sram_window(&snapshot->sram_windows[2], sram_watchobject_stack);
+}
+
+static void *run_live_view(void *arg) {
+  // waiting for a key doubles as the timer for the frames
+  timeout(LIVE_VIEW_FRAME_MS);
+  while (!atomic_load(&live_view_stopping)) {
+    int ch = getch();
+    if (ch == KEY_RESIZE) {
+      update_term_and_box_sizes();
+    } else if (ch != ERR) {
+      atomic_fetch_or(&live_view_events, LIVE_VIEW_PAUSE);
+      break;
+    }
+    draw_live_frame(&snapshots[atomic_load(&published_snapshot)]);
+    atomic_fetch_or(&live_view_events, LIVE_VIEW_FRAME_REQUESTED);
+  }
+  timeout(-1);
+  return NULL;
+}
+
+void start_live_view() {
+  fill_live_snapshot(&snapshots[0]);
+  atomic_store(&published_snapshot, 0);
+  atomic_store(&live_view_events, 0);
+  atomic_store(&live_view_stopping, false);
+  if (pthread_create(&live_view_thread, NULL, run_live_view, NULL) != 0) {
+    // without the thread (c)ontinue just doesn't show anything until the
+    // next breakpoint, like before
+    return;
+  }
+  live_view_active = true;
+}
+
+// called by the emulator before each instruction, so the common case has to be
+// a single load
+void check_live_view() {
+  if (!atomic_load_explicit(&live_view_events, memory_order_relaxed)) {
+    return;
+  }
+  unsigned events = atomic_exchange(&live_view_events, 0);
+  if (events & LIVE_VIEW_PAUSE) {
+    stop_live_view();
+    breakpoint_encountered = true;
+  } else if (events & LIVE_VIEW_FRAME_REQUESTED) {
+    unsigned back = 1 - atomic_load(&published_snapshot);
+    fill_live_snapshot(&snapshots[back]);
+    atomic_store(&published_snapshot, back);
+  }
+}
+
+// the terminal belongs to the emulator thread again afterwards
+void stop_live_view() {
+  if (!live_view_active) {
+    return;
+  }
+  atomic_store(&live_view_stopping, true);
+  pthread_join(live_view_thread, NULL);
+  live_view_active = false;
+}
+
+uint32_t snapshot_sram_cell(const Live_Snapshot *snapshot, uint64_t idx) {
+  for (uint8_t i = 0; i < NUM_SRAM_WINDOWS; i++) {
+    const Sram_Window *window = &snapshot->sram_windows[i];
+    if (window->start <= idx && idx < window->start + window->len) {
+      return window->cells[idx - window->start];
+    }
+  }
+  return 0;
+}
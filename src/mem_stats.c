@@ -0,0 +1,165 @@
+#include "../include/mem_stats.h"
+#include "../include/assemble.h"
+#include "../include/debug.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include "../include/utils.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+bool mem_stats_active = false;
+bool heatmap_active = false;
+
+const char *mem_type_to_name[] = {"Registers",        "EPROM",
+                                  "UART",             "SRAM Codesegment",
+                                  "SRAM Datasegment", "SRAM Stack"};
+
+static uint64_t region_reads[NUM_MEM_TYPES];
+static uint64_t region_writes[NUM_MEM_TYPES];
+
+// the pages of the EPROM come first, then the one page of the UART and then
+// the pages of the SRAM
+static uint64_t *page_reads, *page_writes;
+static uint32_t num_eprom_pages, num_pages;
+
+// only allocated for the heatmap of the Ncurses Debug TUI
+static uint32_t *sram_cell_accesses = NULL;
+
+MemType mem_type_of_addr(uint32_t addr) {
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    return EPROM;
+  case UART_CONST:
+    return UART;
+  default: { // SRAM_CONST
+    uint32_t idx = addr & 0x7FFFFFFF;
+    if (idx < (regs[DS] & 0x7FFFFFFF)) {
+      return SRAM_C;
+    } else if (idx > (regs[SP] & 0x7FFFFFFF)) {
+      return SRAM_S;
+    }
+    return SRAM_D;
+  }
+  }
+}
+
+void init_mem_stats() {
+  num_eprom_pages = (EPROM_SIZE + page_size - 1) / page_size;
+  num_pages = num_eprom_pages + 1 + ((uint64_t)sram_size + page_size - 1) /
+                                        page_size;
+  page_reads = calloc(num_pages, sizeof(uint64_t));
+  page_writes = calloc(num_pages, sizeof(uint64_t));
+  if (heatmap_active && debug_mode && !legacy_debug_tui) {
+    sram_cell_accesses = calloc(sram_size, sizeof(uint32_t));
+  }
+  if (!page_reads || !page_writes) {
+    fprintf(stderr, "Error: Failed to allocate memory statistics\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static uint32_t page_of_addr(uint32_t addr) {
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    return min(addr / page_size, num_eprom_pages - 1);
+  case UART_CONST:
+    return num_eprom_pages;
+  default: // SRAM_CONST
+    return min(num_eprom_pages + 1 + (addr & 0x7FFFFFFF) / page_size,
+               num_pages - 1);
+  }
+}
+
+void record_mem_access(uint32_t addr, bool is_write) {
+  MemType mem_type = mem_type_of_addr(addr);
+  uint32_t page = page_of_addr(addr);
+  if (is_write) {
+    region_writes[mem_type]++;
+    page_writes[page]++;
+  } else {
+    region_reads[mem_type]++;
+    page_reads[page]++;
+  }
+  if (sram_cell_accesses && (addr >> 31) &&
+      (addr & 0x7FFFFFFF) < sram_size) {
+    sram_cell_accesses[addr & 0x7FFFFFFF]++;
+  }
+}
+
+// 0 means never accessed, the levels afterwards are orders of magnitude
+uint8_t heat_level_of_sram_cell(uint64_t idx) {
+  if (!sram_cell_accesses || idx >= sram_size) {
+    return 0;
+  }
+  uint32_t accesses = sram_cell_accesses[idx];
+  uint8_t level = 0;
+  while (accesses > 0 && level < NUM_HEAT_LEVELS) {
+    level++;
+    accesses /= 10;
+  }
+  return level;
+}
+
+static int compare_pages_by_accesses(const void *a, const void *b) {
+  uint32_t page_a = *(const uint32_t *)a, page_b = *(const uint32_t *)b;
+  uint64_t accesses_a = page_reads[page_a] + page_writes[page_a];
+  uint64_t accesses_b = page_reads[page_b] + page_writes[page_b];
+  return (accesses_a < accesses_b) - (accesses_a > accesses_b);
+}
+
+static void print_page(uint32_t page) {
+  if (page < num_eprom_pages) {
+    fprintf(stderr, "  EPROM page %u (%u-%u)", page, page * page_size,
+            (page + 1) * page_size - 1);
+  } else if (page == num_eprom_pages) {
+    fprintf(stderr, "  UART");
+  } else {
+    uint32_t sram_page = page - num_eprom_pages - 1;
+    fprintf(stderr, "  SRAM page %u (%" PRIu64 "-%" PRIu64 ")", sram_page,
+            (uint64_t)sram_page * page_size,
+            (uint64_t)min(((uint64_t)sram_page + 1) * page_size, sram_size) -
+                1);
+  }
+  fprintf(stderr, ": %" PRIu64 " reads, %" PRIu64 " writes\n", page_reads[page],
+          page_writes[page]);
+}
+
+void print_mem_stats() {
+  fprintf(stderr, "Memory access statistics (page size %u):\n", page_size);
+  for (uint8_t i = EPROM; i < NUM_MEM_TYPES; i++) {
+    fprintf(stderr, "  %-17s %10" PRIu64 " reads %10" PRIu64 " writes",
+            mem_type_to_name[i], region_reads[i], region_writes[i]);
+    if (region_writes[i] > 0) {
+      fprintf(stderr, "  read/write ratio %.2f\n",
+              (double)region_reads[i] / region_writes[i]);
+    } else {
+      fprintf(stderr, "\n");
+    }
+  }
+
+  uint32_t *touched_pages = malloc(sizeof(uint32_t) * num_pages);
+  uint32_t num_touched_pages = 0;
+  uint32_t num_touched_sram_pages = 0;
+  for (uint32_t i = 0; i < num_pages; i++) {
+    if (page_reads[i] + page_writes[i] > 0) {
+      touched_pages[num_touched_pages++] = i;
+      if (i > num_eprom_pages) {
+        num_touched_sram_pages++;
+      }
+    }
+  }
+  fprintf(stderr,
+          "Working set: %u pages, thereof %u SRAM pages (%" PRIu64 " words)\n",
+          num_touched_pages, num_touched_sram_pages,
+          (uint64_t)num_touched_sram_pages * page_size);
+
+  qsort(touched_pages, num_touched_pages, sizeof(uint32_t),
+        compare_pages_by_accesses);
+  fprintf(stderr, "Hot pages:\n");
+  for (uint32_t i = 0; i < num_touched_pages && i < NUM_HOT_PAGES; i++) {
+    print_page(touched_pages[i]);
+  }
+  free(touched_pages);
+}
@@ -1,8 +1,23 @@
 #include "../include/parse_args.h"
+#include "../include/branch_pred.h"
+#include "../include/cache.h"
+#include "../include/dap.h"
+#include "../include/gdb_stub.h"
+#include "../include/input_output.h"
 #include "../include/interpr.h"
 #include "../include/interrupt.h"
+#include "../include/mem_stats.h"
+#include "../include/pipeline.h"
+#include "../include/protocol.h"
+#include "../include/record.h"
 #include "../include/reti.h"
+#include "../include/shm_export.h"
+#include "../include/snapshot.h"
+#include "../include/timing.h"
+#include "../include/trace.h"
 #include "../include/utils.h"
+#include <getopt.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -20,6 +35,7 @@ uint8_t radius = 2;
 uint8_t max_waiting_instrs = 10;
 bool verbose = false;
 bool legacy_debug_tui = false;
+bool legacy_diff_active = false;
 bool ds_vals_unsigned = false;
 bool ds_address_extension = false;
 
@@ -28,6 +44,54 @@ char *eprom_prgrm_path = "";
 char *sram_prgrm_path = "";
 char *isrs_prgrm_path = "";
 
+// options without a short form start after the range of characters
+enum {
+  TRACE_OPT = UCHAR_MAX + 1,
+  TRACE_DELTA_OPT,
+  MEM_STATS_OPT,
+  HEATMAP_OPT,
+  CACHE_OPT,
+  TIMING_OPT,
+  BRANCH_PRED_OPT,
+  PIPELINE_OPT,
+  PIPELINE_REPORT_OPT,
+  SAVE_SNAPSHOT_OPT,
+  LOAD_SNAPSHOT_OPT,
+  RECORD_OPT,
+  REPLAY_OPT,
+  SEED_OPT,
+  DEBUG_SCRIPT_OPT,
+  LEGACY_DIFF_OPT,
+  PROTOCOL_OPT,
+  DAP_OPT,
+  GDB_OPT,
+  SHM_OPT,
+};
+
+static const struct option long_opts[] = {
+    {"trace", required_argument, NULL, TRACE_OPT},
+    {"trace-delta", no_argument, NULL, TRACE_DELTA_OPT},
+    {"mem-stats", no_argument, NULL, MEM_STATS_OPT},
+    {"heatmap", no_argument, NULL, HEATMAP_OPT},
+    {"cache", required_argument, NULL, CACHE_OPT},
+    {"timing", required_argument, NULL, TIMING_OPT},
+    {"branch-pred", required_argument, NULL, BRANCH_PRED_OPT},
+    {"pipeline", no_argument, NULL, PIPELINE_OPT},
+    {"pipeline-report", required_argument, NULL, PIPELINE_REPORT_OPT},
+    {"save-snapshot", required_argument, NULL, SAVE_SNAPSHOT_OPT},
+    {"load-snapshot", required_argument, NULL, LOAD_SNAPSHOT_OPT},
+    {"record", required_argument, NULL, RECORD_OPT},
+    {"replay", required_argument, NULL, REPLAY_OPT},
+    {"seed", required_argument, NULL, SEED_OPT},
+    {"debug-script", required_argument, NULL, DEBUG_SCRIPT_OPT},
+    {"legacy-diff", no_argument, NULL, LEGACY_DIFF_OPT},
+    {"protocol", no_argument, NULL, PROTOCOL_OPT},
+    {"dap", no_argument, NULL, DAP_OPT},
+    {"gdb", required_argument, NULL, GDB_OPT},
+    {"shm", required_argument, NULL, SHM_OPT},
+    {NULL, 0, NULL, 0},
+};
+
 void print_help(char *bin_name) {
   fprintf(
       stderr,
@@ -36,6 +100,20 @@ void print_help(char *bin_name) {
       "-w max_waiting_instrs -t (test mode) -m (read metadata) -v (verbose) "
       "-b (binary mode) -E (extended features) -a (all) -l (legacy debug TUI) "
       "-u (ds vals unsigned) -I timer_interrupt_interval -h (help page) "
+      "--trace trace_path --trace-delta (delta compressed trace) "
+      "--mem-stats (memory access statistics) --heatmap (color SRAM cells) "
+      "--cache size:assoc:line_size[:lru|fifo|random[:wb|wt]] "
+      "--timing timing_config_path "
+      "--branch-pred static|1bit|2bit|gshare[:bits] "
+      "--pipeline (pipeline simulation) --pipeline-report csv_path "
+      "--save-snapshot snapshot_path --load-snapshot snapshot_path "
+      "--record record_path --replay record_path --seed seed "
+      "--debug-script script_path "
+      "--legacy-diff (redraw only changed lines of the legacy debug TUI) "
+      "--protocol (JSON lines debugger protocol on stdin and stdout) "
+      "--dap (Debug Adapter Protocol server on stdin and stdout) "
+      "--gdb port_or_socket_path (GDB remote serial protocol stub) "
+      "--shm name (publish the state into POSIX shared memory) "
       "prgrm_path\n",
       bin_name);
 }
@@ -43,7 +121,8 @@ void print_help(char *bin_name) {
 void parse_args(uint8_t argc, char *argv[]) {
   uint32_t opt;
 
-  while ((opt = getopt(argc, argv, "s:p:r:f:e:i:w:hdDvtmbEaulI:")) != -1) {
+  while ((opt = getopt_long(argc, argv, "s:p:r:f:e:i:w:hdDvtmbEaulI:",
+                            long_opts, NULL)) != -1) {
     char *endptr;
     int64_t tmp_val;
 
@@ -74,8 +153,8 @@ void parse_args(uint8_t argc, char *argv[]) {
         fprintf(stderr, "Error: Invalid page size\n");
         exit(EXIT_FAILURE);
       }
-      if (tmp_val < 0 || tmp_val > UINT16_MAX) {
-        fprintf(stderr, "Error: Page size must be between 0 and 65535\n");
+      if (tmp_val < 1 || tmp_val > UINT16_MAX) {
+        fprintf(stderr, "Error: Page size must be between 1 and 65535\n");
         exit(EXIT_FAILURE);
       }
       page_size = tmp_val;
@@ -157,12 +236,121 @@ void parse_args(uint8_t argc, char *argv[]) {
       }
       interrupt_timer_interval = tmp_val;
       break;
+    case TRACE_OPT:
+      trace_active = true;
+      trace_path = optarg;
+      break;
+    case TRACE_DELTA_OPT:
+      trace_delta = true;
+      break;
+    case MEM_STATS_OPT:
+      mem_stats_active = true;
+      break;
+    case HEATMAP_OPT:
+      mem_stats_active = true;
+      heatmap_active = true;
+      break;
+    case CACHE_OPT:
+      if (!parse_cache_config(optarg)) {
+        fprintf(stderr, "Error: Cache configuration must be "
+                        "size:assoc:line_size[:lru|fifo|random[:wb|wt]] with "
+                        "powers of two in words\n");
+        exit(EXIT_FAILURE);
+      }
+      cache_active = true;
+      break;
+    case TIMING_OPT:
+      timing_active = true;
+      timing_path = optarg;
+      break;
+    case BRANCH_PRED_OPT:
+      if (!parse_branch_pred_config(optarg)) {
+        fprintf(stderr, "Error: Branch predictor must be static, 1bit, 2bit "
+                        "or gshare, optionally followed by :bits with bits "
+                        "between 1 and 24\n");
+        exit(EXIT_FAILURE);
+      }
+      branch_pred_active = true;
+      break;
+    case PIPELINE_OPT:
+      pipeline_active = true;
+      break;
+    case PIPELINE_REPORT_OPT:
+      pipeline_active = true;
+      pipeline_report_path = optarg;
+      break;
+    case SAVE_SNAPSHOT_OPT:
+      save_snapshot_path = optarg;
+      break;
+    case LOAD_SNAPSHOT_OPT:
+      load_snapshot_path = optarg;
+      break;
+    case RECORD_OPT:
+      record_active = true;
+      record_path = optarg;
+      break;
+    case REPLAY_OPT:
+      replay_active = true;
+      replay_path = optarg;
+      break;
+    case SEED_OPT:
+      seed = strtoull(optarg, &endptr, 10);
+      if (endptr == optarg || *endptr != '\0' || optarg[0] == '-') {
+        fprintf(stderr, "Error: Seed must be a non-negative integer\n");
+        exit(EXIT_FAILURE);
+      }
+      break;
+    case DEBUG_SCRIPT_OPT:
+      // the dispatcher of the legacy TUI reads the commands
+      debug_mode = true;
+      legacy_debug_tui = true;
+      debug_script_active = true;
+      debug_script_path = optarg;
+      break;
+    case LEGACY_DIFF_OPT:
+      debug_mode = true;
+      legacy_debug_tui = true;
+      legacy_diff_active = true;
+      break;
+    case PROTOCOL_OPT:
+      // like the debug script without a terminal, but the front-end answers
+      debug_mode = true;
+      legacy_debug_tui = true;
+      protocol_active = true;
+      break;
+    case DAP_OPT:
+      // the editor is the front-end, the program is still given as argument
+      debug_mode = true;
+      legacy_debug_tui = true;
+      dap_active = true;
+      break;
+    case GDB_OPT:
+      // stdin and stdout stay with the UART, GDB connects to a socket
+      debug_mode = true;
+      legacy_debug_tui = true;
+      gdb_active = true;
+      gdb_address = optarg;
+      break;
+    case SHM_OPT:
+      shm_export_active = true;
+      shm_export_name = optarg;
+      break;
     default:
       print_help(argv[0]);
       exit(EXIT_FAILURE);
     }
   }
 
+  if (record_active && replay_active) {
+    fprintf(stderr, "Error: Can't record and replay at the same time\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (protocol_active + dap_active + gdb_active > 1) {
+    fprintf(stderr, "Error: Only one debugger protocol can be used\n");
+    exit(EXIT_FAILURE);
+  }
+
   if (optind >= argc) {
     fprintf(stderr, "Expected argument after options\n");
     print_help(argv[0]);
@@ -187,9 +375,30 @@ void print_args() {
          ds_vals_unsigned ? "true" : "false");
   printf("Extended features: %s\n", extended_features ? "true" : "false");
   printf("Legacy debug TUI: %s\n", legacy_debug_tui ? "true" : "false");
+  printf("Legacy diff: %s\n", legacy_diff_active ? "true" : "false");
+  printf("Debugger protocol: %s\n", protocol_active ? "true" : "false");
+  printf("Debug Adapter Protocol: %s\n", dap_active ? "true" : "false");
+  printf("GDB stub address: %s\n", gdb_address);
+  printf("Shared memory name: %s\n", shm_export_name);
   printf("Radius: %u\n", radius);
   printf("Peripheral file directory: %s\n", peripherals_dir);
   printf("Eprom program path: %s\n", eprom_prgrm_path);
   printf("Interrupt service routines program path: %s\n", isrs_prgrm_path);
   printf("SRAM program path: %s\n", sram_prgrm_path);
+  printf("Trace path: %s\n", trace_path);
+  printf("Delta compressed trace: %s\n", trace_delta ? "true" : "false");
+  printf("Memory access statistics: %s\n",
+         mem_stats_active ? "true" : "false");
+  printf("Heatmap: %s\n", heatmap_active ? "true" : "false");
+  printf("Cache: %s\n", cache_active ? "true" : "false");
+  printf("Timing config path: %s\n", timing_path);
+  printf("Branch prediction: %s\n", branch_pred_active ? "true" : "false");
+  printf("Pipeline simulation: %s\n", pipeline_active ? "true" : "false");
+  printf("Pipeline report path: %s\n", pipeline_report_path);
+  printf("Save snapshot path: %s\n", save_snapshot_path);
+  printf("Load snapshot path: %s\n", load_snapshot_path);
+  printf("Record path: %s\n", record_path);
+  printf("Replay path: %s\n", replay_path);
+  printf("Seed: %" PRIu64 "\n", seed);
+  printf("Debug script path: %s\n", debug_script_path);
 }
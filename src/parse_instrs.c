@@ -1,4 +1,5 @@
 #include "../include/parse_instrs.h"
+#include "../include/breakpoints.h"
 #include "../include/error.h"
 #include "../include/interpr.h"
 #include "../include/reti.h"
@@ -104,17 +105,21 @@ void parse_and_load_program(char *prgrm, Program_Type prgrm_type) {
   }
 
   error_context.code_begin = prgrm_pntr;
+  uint32_t line = 1;
   while (*prgrm_pntr != '\0') {
     error_context.code_current = prgrm_pntr;
+    const char *instr_begin = prgrm_pntr;
     String_Instruction *str_instr = parse_instr(&prgrm_pntr);
     if (isalpha(*str_instr->op)) {
       // the if solves the problem of empty lines or empty space between ';'
       uint32_t machine_instr = assembly_to_machine(str_instr);
       switch (prgrm_type) {
       case SRAM_PRGRM:
+        record_line_addr(prgrm_type, line, (uint32_t)SRAM_CONST << 30 | i);
         write_file(sram, i++, machine_instr);
         break;
       case ISR_PRGRMS:
+        record_line_addr(prgrm_type, line, (uint32_t)SRAM_CONST << 30 | i);
         if (strcmp(str_instr->op, "IVTE") == 0) {
           ivt_max_idx = i;
         }
@@ -129,12 +134,16 @@ void parse_and_load_program(char *prgrm, Program_Type prgrm_type) {
           exit(EXIT_FAILURE);
         }
         eprom = temp;
+        record_line_addr(prgrm_type, line, i);
         write_array(eprom, i++, machine_instr, false);
       } break;
       default:
         fprintf(stderr, "Error: Invalid memory type\n");
       }
     }
+    for (const char *c = instr_begin; c < prgrm_pntr; c++) {
+      line += *c == '\n';
+    }
   }
   switch (prgrm_type) {
   case SRAM_PRGRM:
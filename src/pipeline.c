@@ -0,0 +1,224 @@
+#include "../include/pipeline.h"
+#include "../include/assemble.h"
+#include "../include/branch_pred.h"
+#include "../include/interpr.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+bool pipeline_active = false;
+char *pipeline_report_path = "";
+
+uint64_t pipeline_instrs = 0;
+Pipeline_Timeline with_forwarding, without_forwarding;
+
+static uint32_t expected_pc;
+
+typedef struct {
+  uint8_t srcs;  // bit i set means register i is read
+  uint8_t dests; // bit i set means register i is written
+  bool mem_result;
+  uint8_t control_penalty;
+} Instr_Deps;
+
+static uint8_t reg_bit(uint32_t reg) {
+  return reg < NUM_REGISTERS ? 1 << reg : 0;
+}
+
+static void reset_timeline(Pipeline_Timeline *timeline) {
+  *timeline = (Pipeline_Timeline){0};
+  // the first instruction is fetched in cycle 1 and decoded in cycle 2
+  timeline->next_ex = 3;
+}
+
+void init_pipeline() {
+  reset_timeline(&with_forwarding);
+  reset_timeline(&without_forwarding);
+  pipeline_instrs = 0;
+  expected_pc = read_array(regs, PC, false);
+}
+
+// the registers that are read and written, including the implicit ones,
+// PC is left out because the pipeline always knows it
+static Instr_Deps deps_of_instr(Instruction *instr) {
+  Instr_Deps deps = {0};
+  uint8_t op = instr->op;
+  if (op <= ANDI) {
+    deps.srcs = reg_bit(instr->opd1);
+    deps.dests = reg_bit(instr->opd1);
+  } else if (op <= ANDR) {
+    deps.srcs = reg_bit(instr->opd1) | reg_bit(instr->opd2);
+    deps.dests = reg_bit(instr->opd1);
+  } else if (op <= ANDM) {
+    deps.srcs = reg_bit(instr->opd1) | reg_bit(DS);
+    deps.dests = reg_bit(instr->opd1);
+    deps.mem_result = true;
+  } else {
+    switch (op) {
+    case LOAD:
+      deps.srcs = reg_bit(DS);
+      deps.dests = reg_bit(instr->opd1);
+      deps.mem_result = true;
+      break;
+    case LOADIN:
+      deps.srcs = reg_bit(instr->opd1);
+      deps.dests = reg_bit(instr->opd2);
+      deps.mem_result = true;
+      break;
+    case LOADI:
+      deps.dests = reg_bit(instr->opd1);
+      break;
+    case STORE:
+      deps.srcs = reg_bit(instr->opd1) | reg_bit(DS);
+      break;
+    case STOREIN:
+      deps.srcs = reg_bit(instr->opd1) | reg_bit(instr->opd2);
+      break;
+    case MOVE:
+      deps.srcs = reg_bit(instr->opd1);
+      deps.dests = reg_bit(instr->opd2);
+      break;
+    case INT:
+    case RTI:
+      // the breakpoint of the debugger only goes on to the next instruction
+      if (op == INT && instr->opd1 == 3) {
+        break;
+      }
+      deps.srcs = reg_bit(SP);
+      deps.dests = reg_bit(SP) | reg_bit(PC);
+      deps.mem_result = true;
+      break;
+    case JUMP:
+      deps.control_penalty = JUMP_PENALTY;
+      break;
+    case NOP:
+      break;
+    default: { // conditional JUMP family, which reads ACC implicitly
+      deps.srcs = reg_bit(ACC);
+      // a jump by 1 goes where the next instruction is, but it is taken
+      bool taken = jump_condition_holds(op, read_array(regs, ACC, false));
+      bool mispredicted =
+          branch_pred_active ? !last_prediction_correct : taken;
+      if (mispredicted) {
+        deps.control_penalty = EX_PC_WRITE_PENALTY;
+      }
+      break;
+    }
+    }
+  }
+  if (deps.dests & reg_bit(PC)) {
+    deps.control_penalty =
+        deps.mem_result ? MEM_PC_WRITE_PENALTY : EX_PC_WRITE_PENALTY;
+  }
+  deps.srcs &= ~reg_bit(PC);
+  deps.dests &= ~reg_bit(PC);
+  return deps;
+}
+
+static void schedule(Pipeline_Timeline *timeline, Instr_Deps *deps,
+                     bool forwarding) {
+  uint64_t ex = timeline->next_ex;
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    if ((deps->srcs & (1 << i)) && timeline->reg_ready[i] > ex) {
+      ex = timeline->reg_ready[i];
+    }
+  }
+  timeline->data_stalls += ex - timeline->next_ex;
+
+  // without forwarding the value is written in WB in the first half of the
+  // cycle and read in ID in the second half
+  for (uint8_t i = 0; forwarding && i < NUM_REGISTERS; i++) {
+    if ((deps->srcs & (1 << i)) && timeline->reg_producer_ex[i] + 3 > ex) {
+      timeline->forwards++;
+    }
+  }
+  uint64_t ready = forwarding ? ex + (deps->mem_result ? 2 : 1) : ex + 3;
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    if (deps->dests & (1 << i)) {
+      timeline->reg_ready[i] = ready;
+      timeline->reg_producer_ex[i] = ex;
+    }
+  }
+
+  timeline->control_stalls += deps->control_penalty;
+  timeline->next_ex = ex + 1 + deps->control_penalty;
+  timeline->last_ex = ex;
+}
+
+// called after the instruction was executed, so the new PC tells where the
+// next instruction is expected
+void pipeline_instr(uint32_t pc, Instruction *instr) {
+  // interrupts from devices redirect the PC between instructions
+  if (pc != expected_pc) {
+    with_forwarding.next_ex += EX_PC_WRITE_PENALTY;
+    with_forwarding.control_stalls += EX_PC_WRITE_PENALTY;
+    without_forwarding.next_ex += EX_PC_WRITE_PENALTY;
+    without_forwarding.control_stalls += EX_PC_WRITE_PENALTY;
+  }
+  Instr_Deps deps = deps_of_instr(instr);
+  schedule(&with_forwarding, &deps, true);
+  schedule(&without_forwarding, &deps, false);
+  pipeline_instrs++;
+  expected_pc = read_array(regs, PC, false);
+}
+
+// the last instruction leaves WB two cycles after its EX
+uint64_t pipeline_cycles(Pipeline_Timeline *timeline) {
+  return pipeline_instrs > 0 ? timeline->last_ex + 2 : 0;
+}
+
+static void write_pipeline_report() {
+  FILE *file = fopen(pipeline_report_path, "a+");
+  if (!file) {
+    fprintf(stderr, "Error: Can't open pipeline report %s\n",
+            pipeline_report_path);
+    return;
+  }
+  fseek(file, 0, SEEK_END);
+  if (ftell(file) == 0) {
+    fprintf(file, "program,instructions,cycles,cpi,data_stalls,"
+                  "control_stalls,forwards,cycles_without_forwarding,"
+                  "cpi_without_forwarding\n");
+  }
+  uint64_t cycles = pipeline_cycles(&with_forwarding);
+  uint64_t cycles_without = pipeline_cycles(&without_forwarding);
+  fprintf(file,
+          "%s,%" PRIu64 ",%" PRIu64 ",%.3f,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+          ",%" PRIu64 ",%.3f\n",
+          sram_prgrm_path, pipeline_instrs, cycles,
+          pipeline_instrs ? (double)cycles / pipeline_instrs : 0.0,
+          with_forwarding.data_stalls, with_forwarding.control_stalls,
+          with_forwarding.forwards, cycles_without,
+          pipeline_instrs ? (double)cycles_without / pipeline_instrs : 0.0);
+  fclose(file);
+}
+
+void print_pipeline_stats() {
+  uint64_t cycles = pipeline_cycles(&with_forwarding);
+  uint64_t cycles_without = pipeline_cycles(&without_forwarding);
+  fprintf(stderr, "Pipeline (IF ID EX MEM WB):\n");
+  fprintf(stderr, "  %" PRIu64 " instructions, %" PRIu64 " cycles",
+          pipeline_instrs, cycles);
+  if (pipeline_instrs > 0) {
+    fprintf(stderr, ", CPI %.3f", (double)cycles / pipeline_instrs);
+  }
+  fprintf(stderr,
+          "\n  %" PRIu64 " data hazard stalls, %" PRIu64
+          " control hazard stalls, %" PRIu64 " forwarded operands\n",
+          with_forwarding.data_stalls, with_forwarding.control_stalls,
+          with_forwarding.forwards);
+  fprintf(stderr,
+          "  without forwarding: %" PRIu64 " cycles, %" PRIu64
+          " data hazard stalls",
+          cycles_without, without_forwarding.data_stalls);
+  if (pipeline_instrs > 0) {
+    fprintf(stderr, ", CPI %.3f", (double)cycles_without / pipeline_instrs);
+  }
+  fprintf(stderr, "\n");
+  if (*pipeline_report_path) {
+    write_pipeline_report();
+  }
+}
@@ -0,0 +1,408 @@
+#include "../include/protocol.h"
+#include "../include/assemble.h"
+#include "../include/breakpoints.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/json.h"
+#include "../include/parse_args.h"
+#include "../include/record.h"
+#include "../include/reti.h"
+#include "../include/run_until.h"
+#include "../include/snapshot.h"
+#include "../include/special_opts.h"
+#include "../include/uart.h"
+#include "../include/undo.h"
+#include "../include/watchpoints.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool protocol_active = false;
+
+typedef struct {
+  const char *name;
+  // changes the machine, which isn't possible while an instruction is
+  // waiting for input
+  bool runs_machine;
+  // returns an error message or NULL, resume continues the execution
+  const char *(*handle)(const Json_Object *request, Json_Writer *response,
+                        bool *resume);
+} Protocol_Command;
+
+// the input an instruction is waiting for
+static char *pending_input = NULL;
+static uint8_t pending_input_max_len;
+
+static void send_line(Json_Writer *writer) {
+  fwrite(writer->data, 1, writer->len, stdout);
+  putchar('\n');
+  fflush(stdout);
+}
+
+void send_protocol_message(const char *event, const char *message) {
+  Json_Writer writer = {NULL, 0, 0};
+  json_begin_object(&writer, NULL);
+  json_str(&writer, "event", event);
+  json_str(&writer, "message", message);
+  json_end_object(&writer);
+  send_line(&writer);
+  fin_json_writer(&writer);
+}
+
+static void send_state_event(const char *event) {
+  Json_Writer writer = {NULL, 0, 0};
+  json_begin_object(&writer, NULL);
+  json_str(&writer, "event", event);
+  json_uint(&writer, "pc", regs[PC]);
+  json_uint(&writer, "instrs", num_executed_instrs);
+  json_end_object(&writer);
+  send_line(&writer);
+  fin_json_writer(&writer);
+}
+
+static const char *step_cmd(const Json_Object *request,
+                            Json_Writer *response, bool *resume) {
+  int64_t count;
+  if (json_get_num(request, "count", &count)) {
+    char num_steps[MAX_CHARS_RUN_UNTIL + 1];
+    if (count < 1 || count > UINT32_MAX) {
+      return "Invalid number of steps";
+    }
+    snprintf(num_steps, sizeof(num_steps), "%" PRId64, count);
+    if (!parse_num_steps(num_steps)) {
+      return "Invalid number of steps";
+    }
+    breakpoint_encountered = false;
+  }
+  *resume = true;
+  return NULL;
+}
+
+static const char *continue_cmd(const Json_Object *request,
+                                Json_Writer *response, bool *resume) {
+  breakpoint_encountered = false;
+  *resume = true;
+  return NULL;
+}
+
+static const char *run_until_cmd(const Json_Object *request,
+                                 Json_Writer *response, bool *resume) {
+  const char *until = json_get_str(request, "until");
+  if (!until || strlen(until) > MAX_CHARS_RUN_UNTIL ||
+      !parse_run_until(until)) {
+    return "Invalid run until command, e.g. p 42";
+  }
+  breakpoint_encountered = false;
+  *resume = true;
+  return NULL;
+}
+
+static const char *step_into_cmd(const Json_Object *request,
+                                 Json_Writer *response, bool *resume) {
+  Instruction *instr = machine_to_assembly(read_storage_raw(regs[PC]));
+  bool is_int = instr->op == INT;
+  free(instr);
+  if (!is_int) {
+    return "No INT instruction at the PC";
+  }
+  step_into_activated = true;
+  *resume = true;
+  return NULL;
+}
+
+static const char *finish_cmd(const Json_Object *request,
+                              Json_Writer *response, bool *resume) {
+  if (!isr_active) {
+    return "No interrupt service routine active";
+  }
+  isr_finished = false;
+  *resume = true;
+  return NULL;
+}
+
+static const char *interrupt_cmd(const Json_Object *request,
+                                 Json_Writer *response, bool *resume) {
+  // the reasons why it wasn't triggered are sent as messages
+  *resume = keypress_interrupt_trigger();
+  return NULL;
+}
+
+static const char *step_back_cmd(const Json_Object *request,
+                                 Json_Writer *response, bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  }
+  int64_t count = 1;
+  if (json_member(request, "count") &&
+      !json_get_num(request, "count", &count)) {
+    return "Invalid number of steps";
+  }
+  if (count < 0 || (uint64_t)count > num_undoable_instrs()) {
+    return "Not that many instructions to undo";
+  }
+  for (int64_t i = 0; i < count; i++) {
+    step_back();
+  }
+  return NULL;
+}
+
+static const char *back_to_breakpoint_cmd(const Json_Object *request,
+                                          Json_Writer *response,
+                                          bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  }
+  step_back_to_breakpoint();
+  return NULL;
+}
+
+static const char *restart_cmd(const Json_Object *request,
+                               Json_Writer *response, bool *resume) {
+  if (record_active || replay_active) {
+    return "Not possible while recording or replaying";
+  }
+  restart_from_snapshot();
+  return NULL;
+}
+
+// without a condition the breakpoint is toggled, like with k and K
+static const char *breakpoint_cmd(const Json_Object *request,
+                                  Json_Writer *response, bool *resume) {
+  const char *location = json_get_str(request, "location");
+  uint32_t addr = location && strlen(location) <= MAX_CHARS_BREAKPOINT
+                      ? parse_breakpoint_location(location)
+                      : NO_ADDR;
+  if (addr == NO_ADDR) {
+    return "No instruction at this address or line";
+  }
+  const char *condition_str = json_get_str(request, "condition");
+  if (condition_str) {
+    Condition condition;
+    if (!compile_condition(condition_str, &condition)) {
+      return "Invalid condition";
+    } else if (!set_conditional_breakpoint(addr, &condition)) {
+      return "No instruction at this address or too many conditions";
+    }
+  } else if (!toggle_breakpoint(addr)) {
+    return "No instruction at this address or line";
+  }
+  json_uint(response, "addr", addr);
+  json_bool(response, "set", is_breakpoint(addr));
+  return NULL;
+}
+
+static const char *watchpoint_cmd(const Json_Object *request,
+                                  Json_Writer *response, bool *resume) {
+  const char *spec = json_get_str(request, "watchpoint");
+  Watchpoint watchpoint;
+  if (!spec || strlen(spec) > MAX_CHARS_WATCHPOINT ||
+      !parse_watchpoint(spec, &watchpoint)) {
+    return "Invalid watchpoint, e.g. rw 2147483848 or "
+           "c 2147549180-2147549183";
+  } else if (!toggle_watchpoint(&watchpoint)) {
+    return "Too many watchpoints";
+  }
+  return NULL;
+}
+
+static const char *registers_cmd(const Json_Object *request,
+                                 Json_Writer *response, bool *resume) {
+  json_begin_object(response, "registers");
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    json_uint(response, register_code_to_name[i], regs[i]);
+  }
+  json_end_object(response);
+  return NULL;
+}
+
+static const char *memory_cmd(const Json_Object *request,
+                              Json_Writer *response, bool *resume) {
+  int64_t addr, count;
+  if (!json_get_num(request, "addr", &addr) || addr < 0 ||
+      addr > UINT32_MAX) {
+    return "Invalid address";
+  }
+  if (!json_get_num(request, "count", &count) || count < 1 ||
+      count > MAX_PROTOCOL_MEM_CELLS) {
+    return "Count must be between 1 and 4096";
+  }
+  uint32_t values[MAX_PROTOCOL_MEM_CELLS];
+  if (!read_storage_range(addr, count, values)) {
+    return "Range exceeds the memory";
+  }
+  json_uint(response, "addr", addr);
+  json_begin_array(response, "values");
+  for (int64_t i = 0; i < count; i++) {
+    json_uint(response, NULL, values[i]);
+  }
+  json_end_array(response);
+  return NULL;
+}
+
+static const char *uart_cmd(const Json_Object *request,
+                            Json_Writer *response, bool *resume) {
+  json_begin_array(response, "registers");
+  for (uint8_t i = 0; i < NUM_UART_ADDRESSES; i++) {
+    json_uint(response, NULL, uart[i]);
+  }
+  json_end_array(response);
+  json_str(response, "datatype", datatype == STRING ? "string" : "integer");
+  json_uint(response, "remaining_bytes", remaining_bytes);
+  json_uint(response, "sending_waiting_time", sending_waiting_time);
+  json_uint(response, "receiving_waiting_time", receiving_waiting_time);
+  json_str(response, "current_send_data",
+           current_send_data ? current_send_data : "");
+  json_str(response, "all_send_data", all_send_data ? all_send_data : "");
+  json_uint(response, "num_outputs", num_uart_outputs);
+  return NULL;
+}
+
+static const char *isr_cmd(const Json_Object *request,
+                           Json_Writer *response, bool *resume) {
+  json_bool(response, "active", isr_active);
+  json_bool(response, "finished", isr_finished);
+  json_bool(response, "step_into", step_into_activated);
+  json_uint(response, "current_isr", current_isr);
+  json_begin_array(response, "priority_stack");
+  for (int16_t i = 0; i <= stack_top; i++) {
+    json_uint(response, NULL, isr_priority_stack[i]);
+  }
+  json_end_array(response);
+  json_bool(response, "timer_active", interrupt_timer_active);
+  json_uint(response, "timer_count", timer_cnt);
+  json_uint(response, "timer_interval", interrupt_timer_interval);
+  json_bool(response, "keypress_active", keypress_interrupt_active);
+  json_uint(response, "num_returns", num_isr_returns);
+  return NULL;
+}
+
+static const char *input_cmd(const Json_Object *request,
+                             Json_Writer *response, bool *resume) {
+  const char *value = json_get_str(request, "value");
+  if (!pending_input) {
+    return "No instruction is waiting for input";
+  } else if (!value) {
+    return "Missing value";
+  } else if (strlen(value) > pending_input_max_len) {
+    return "Input too long";
+  }
+  strcpy(pending_input, value);
+  *resume = true;
+  return NULL;
+}
+
+static const char *quit_cmd(const Json_Object *request,
+                            Json_Writer *response, bool *resume) {
+  finalize();
+  exit(EXIT_SUCCESS);
+}
+
+static const Protocol_Command commands[] = {
+    {"step", true, step_cmd},
+    {"continue", true, continue_cmd},
+    {"run_until", true, run_until_cmd},
+    {"step_into", true, step_into_cmd},
+    {"finish", true, finish_cmd},
+    {"interrupt", true, interrupt_cmd},
+    {"step_back", true, step_back_cmd},
+    {"back_to_breakpoint", true, back_to_breakpoint_cmd},
+    {"restart", true, restart_cmd},
+    {"breakpoint", false, breakpoint_cmd},
+    {"watchpoint", false, watchpoint_cmd},
+    {"registers", false, registers_cmd},
+    {"memory", false, memory_cmd},
+    {"uart", false, uart_cmd},
+    {"isr", false, isr_cmd},
+    {"input", false, input_cmd},
+    {"quit", false, quit_cmd},
+};
+
+static const char *dispatch_request(const Json_Object *request,
+                                    Json_Writer *response, bool *resume) {
+  const char *cmd = json_get_str(request, "cmd");
+  if (!cmd) {
+    return "Missing cmd";
+  }
+  for (uint8_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+    if (strcmp(cmd, commands[i].name) == 0) {
+      if (commands[i].runs_machine && pending_input) {
+        return "Waiting for input";
+      }
+      return commands[i].handle(request, response, resume);
+    }
+  }
+  return "Unknown cmd";
+}
+
+// returns whether the execution continues, a request can wait for input and
+// so for further requests
+static bool handle_next_request() {
+  char line[MAX_LEN_PROTOCOL_LINE + 2];
+  if (!fgets(line, sizeof(line), stdin)) {
+    finalize();
+    exit(EXIT_SUCCESS);
+  }
+
+  const char *error = NULL;
+  Json_Object request;
+  request.num_members = 0;
+  if (!strchr(line, '\n') && !feof(stdin)) {
+    int ch;
+    while ((ch = getchar()) != '\n' && ch != EOF) {
+    }
+    error = "Request too long";
+  } else if (!parse_json_object(line, &request)) {
+    error = "Invalid request";
+  }
+
+  Json_Writer response = {NULL, 0, 0};
+  json_begin_object(&response, NULL);
+  const Json_Member *id = json_member(&request, "id");
+  if (id && id->type == JSON_NUMBER) {
+    json_int(&response, "id", id->num);
+  } else if (id && id->type == JSON_STRING) {
+    json_str(&response, "id", id->str);
+  }
+  size_t len_header = response.len;
+
+  bool resume = false;
+  if (!error) {
+    error = dispatch_request(&request, &response, &resume);
+  }
+  if (error) {
+    response.len = len_header;
+    json_bool(&response, "ok", false);
+    json_str(&response, "error", error);
+    resume = false;
+  } else {
+    json_bool(&response, "ok", true);
+  }
+  json_end_object(&response);
+  send_line(&response);
+  fin_json_writer(&response);
+  return resume;
+}
+
+void evaluate_protocol_requests() {
+  send_state_event("stopped");
+  while (!handle_next_request()) {
+  }
+}
+
+// the requests that don't run the machine are still answered, e.g. to show
+// the output so far before entering a number
+void read_protocol_input(char *input, const char *message,
+                         uint8_t max_num_digits) {
+  pending_input = input;
+  pending_input_max_len = max_num_digits;
+  send_protocol_message("input", message);
+  while (!handle_next_request()) {
+  }
+  pending_input = NULL;
+}
+
+void fin_protocol() { send_state_event("exited"); }
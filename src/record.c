@@ -0,0 +1,139 @@
+#include "../include/record.h"
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/uart.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool record_active = false;
+bool replay_active = false;
+char *record_path = "";
+char *replay_path = "";
+uint64_t seed = 1;
+uint64_t prng_state;
+
+static FILE *record_file = NULL;
+static const char *type_to_name[] = {"rand", "input", "keypress"};
+
+// the event that comes next in the replay
+static Record_Event next_event;
+static bool replay_finished = false;
+
+static void read_next_event() {
+  char name[16];
+  uint64_t instr_idx;
+  uint32_t value;
+  int res = fscanf(record_file, "%" SCNu64 " %15s %" SCNu32, &instr_idx, name,
+                   &value);
+  if (res == EOF) {
+    replay_finished = true;
+    return;
+  }
+  for (uint8_t i = 0; i <= RECORD_KEYPRESS; i++) {
+    if (res == 3 && strcmp(name, type_to_name[i]) == 0) {
+      next_event = (Record_Event){instr_idx, i, value};
+      return;
+    }
+  }
+  fprintf(stderr, "Error: Invalid event in replay file %s\n", replay_path);
+  exit(EXIT_FAILURE);
+}
+
+void init_record() {
+  if (record_active) {
+    record_file = fopen(record_path, "w");
+    if (!record_file) {
+      fprintf(stderr, "Error: Can't open record file %s\n", record_path);
+      exit(EXIT_FAILURE);
+    }
+    fprintf(record_file, "%s %d %" PRIu64 "\n", RECORD_MAGIC, RECORD_VERSION,
+            seed);
+    // like the trace, the recording matters most for runs that end in an error
+    atexit(fin_record);
+  } else if (replay_active) {
+    record_file = fopen(replay_path, "r");
+    char magic[sizeof(RECORD_MAGIC)];
+    int version;
+    if (!record_file ||
+        fscanf(record_file, "%7s %d %" SCNu64, magic, &version, &seed) != 3 ||
+        strcmp(magic, RECORD_MAGIC) != 0 || version != RECORD_VERSION) {
+      fprintf(stderr, "Error: %s is not a readable record file\n",
+              replay_path);
+      exit(EXIT_FAILURE);
+    }
+    read_next_event();
+  }
+  prng_state = seed;
+}
+
+static void record_event(Record_Type type, uint32_t value) {
+  fprintf(record_file, "%" PRIu64 " %s %" PRIu32 "\n", num_executed_instrs,
+          type_to_name[type], value);
+}
+
+static uint32_t replay_event(Record_Type type) {
+  if (replay_finished || next_event.type != type ||
+      next_event.instr_idx != num_executed_instrs) {
+    fprintf(stderr,
+            "Error: Replay diverged at instruction %" PRIu64
+            ", expected %s event\n",
+            num_executed_instrs, type_to_name[type]);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t value = next_event.value;
+  read_next_event();
+  return value;
+}
+
+// splitmix64, every seed gives a good sequence and the whole state of the
+// generator is one number that can go into snapshots
+uint32_t machine_rand() {
+  if (replay_active) {
+    return replay_event(RECORD_RAND);
+  }
+  prng_state += 0x9E3779B97F4A7C15;
+  uint64_t z = prng_state;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+  uint32_t value = (z ^ (z >> 31)) >> 32;
+  if (record_active) {
+    record_event(RECORD_RAND, value);
+  }
+  return value;
+}
+
+uint32_t recorded_user_input() {
+  if (replay_active) {
+    return replay_event(RECORD_INPUT);
+  }
+  uint32_t value = get_user_input();
+  if (record_active) {
+    record_event(RECORD_INPUT, value);
+  }
+  return value;
+}
+
+void record_keypress() {
+  if (record_active) {
+    record_event(RECORD_KEYPRESS, 0);
+  }
+}
+
+// the keypress interrupts happened between two instructions
+void replay_keypresses() {
+  while (!replay_finished && next_event.type == RECORD_KEYPRESS &&
+         next_event.instr_idx == num_executed_instrs) {
+    read_next_event();
+    keypress_interrupt_trigger();
+  }
+}
+
+void fin_record() {
+  if (record_file) {
+    fclose(record_file);
+    record_file = NULL;
+  }
+}
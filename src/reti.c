@@ -1,9 +1,17 @@
 #include "../include/reti.h"
 #include "../include/assemble.h"
+#include "../include/cache.h"
 #include "../include/debug.h"
+#include "../include/disasm_cache.h"
+#include "../include/mem_stats.h"
 #include "../include/parse_args.h"
+#include "../include/snapshot.h"
+#include "../include/timing.h"
+#include "../include/trace.h"
 #include "../include/uart.h"
+#include "../include/undo.h"
 #include "../include/utils.h"
+#include "../include/watchpoints.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -160,7 +168,20 @@ uint32_t read_file(FILE *dev, uint64_t address) {
   return swap_endian_32(big_endian_buffer);
 }
 
+// one seek for many cells, e.g. for the windows of the live view
+void read_file_range(FILE *dev, uint64_t address, uint32_t *buffer,
+                     uint32_t num_cells) {
+  fseek(dev, address * sizeof(uint32_t), SEEK_SET);
+  size_t num_read = fread(buffer, sizeof(uint32_t), num_cells, dev);
+  for (size_t i = 0; i < num_cells; i++) {
+    buffer[i] = i < num_read ? swap_endian_32(buffer[i]) : 0;
+  }
+}
+
 void write_file(FILE *dev, uint64_t addr, uint32_t buffer) {
+  if (dev == sram) {
+    invalidate_disasm((uint32_t)SRAM_CONST << 30 | addr);
+  }
   uint32_t big_endian_buffer = swap_endian_32(buffer);
   fseek(dev, addr * sizeof(uint32_t), SEEK_SET);
   fwrite(&big_endian_buffer, sizeof(uint32_t), 1, dev);
@@ -181,7 +202,8 @@ uint32_t read_storage_sram_constant_fill(uint32_t addr) {
   return read_storage(addr);
 }
 
-uint32_t read_storage(uint32_t addr) {
+// without any of the statistics, e.g. for looking at memory in the debugger
+uint32_t read_storage_raw(uint32_t addr) {
   uint8_t stor_mode = addr >> 30;
   switch (stor_mode) {
   case EPROM_CONST:
@@ -199,12 +221,90 @@ uint32_t read_storage(uint32_t addr) {
   }
 }
 
+// the cells of a range have to lie in the same memory, in the SRAM they are
+// read with one access to the file
+bool read_storage_range(uint32_t addr, uint32_t count, uint32_t *values) {
+  switch (addr >> 30) {
+  case EPROM_CONST:
+    if ((uint64_t)addr + count > num_instrs_start_prgrm) {
+      return false;
+    }
+    memcpy(values, eprom + addr, sizeof(uint32_t) * count);
+    return true;
+  case UART_CONST: {
+    uint32_t idx = addr & 0x3FFFFFFF;
+    if ((uint64_t)idx + count > NUM_UART_ADDRESSES) {
+      return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      values[i] = uart[idx + i];
+    }
+    return true;
+  }
+  default: { // SRAM_CONST
+    uint32_t idx = addr & 0x7FFFFFFF;
+    if ((uint64_t)idx + count > sram_size) {
+      return false;
+    }
+    read_file_range(sram, idx, values, count);
+    return true;
+  }
+  }
+}
+
+uint32_t read_storage(uint32_t addr) {
+  if (mem_stats_active) {
+    record_mem_access(addr, false);
+  }
+  bool cache_hit = false;
+  if (cache_active) {
+    cache_hit = cache_access(addr, false);
+  }
+  if (timing_active) {
+    timing_mem_access(addr, cache_hit);
+  }
+  if (num_watchpoints > 0) {
+    check_watchpoints(addr, false, 0);
+  }
+  return read_storage_raw(addr);
+}
+
+// instruction fetches don't go through the data cache
+uint32_t fetch_instr(uint32_t addr) {
+  if (mem_stats_active) {
+    record_mem_access(addr, false);
+  }
+  if (timing_active) {
+    timing_mem_access(addr, false);
+  }
+  return read_storage_raw(addr);
+}
+
 void write_storage_ds_fill(uint64_t addr, uint32_t buffer) {
   addr = addr | (read_array(regs, DS, false) & 0xffc00000);
   write_storage(addr, buffer);
 }
 
 void write_storage(uint32_t addr, uint32_t buffer) {
+  if (trace_active) {
+    trace_mem_write(addr, buffer);
+  }
+  if (mem_stats_active) {
+    record_mem_access(addr, true);
+  }
+  bool cache_hit = false;
+  if (cache_active) {
+    cache_hit = cache_access(addr, true);
+  }
+  if (timing_active) {
+    timing_mem_access(addr, cache_hit);
+  }
+  if (num_watchpoints > 0) {
+    check_watchpoints(addr, true, buffer);
+  }
+  if (undo_active) {
+    undo_mem_write(addr);
+  }
   uint8_t stor_mode = addr >> 30;
   switch (stor_mode) {
   case EPROM_CONST:
@@ -217,6 +317,11 @@ void write_storage(uint32_t addr, uint32_t buffer) {
     break;
   default: // SRAM_CONST
     addr = addr & 0x7FFFFFFF;
+    if (restart_snapshot_active && addr < restart_tracked_cells &&
+        !(restart_dirty_pages[addr / page_size / 8] &
+          (1 << (addr / page_size % 8)))) {
+      save_page_before_write(addr / page_size);
+    }
     write_file(sram, addr, buffer);
     break;
   }
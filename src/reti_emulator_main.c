@@ -1,12 +1,27 @@
+#include "../include/branch_pred.h"
+#include "../include/breakpoints.h"
+#include "../include/cache.h"
+#include "../include/dap.h"
 #include "../include/error.h"
+#include "../include/gdb_stub.h"
+#include "../include/input_output.h"
 #include "../include/interpr.h"
+#include "../include/mem_stats.h"
 #include "../include/parse_args.h"
 #include "../include/parse_instrs.h"
+#include "../include/pipeline.h"
+#include "../include/record.h"
 #include "../include/reti.h"
+#include "../include/shm_export.h"
+#include "../include/snapshot.h"
 #include "../include/special_opts.h"
+#include "../include/timing.h"
+#include "../include/trace.h"
 #include "../include/tui.h"
 #include "../include/uart.h"
+#include "../include/undo.h"
 #include "../include/utils.h"
+#include "../include/watchpoints.h"
 #include <string.h>
 
 int main(int argc, char *argv[]) {
@@ -23,24 +38,74 @@ int main(int argc, char *argv[]) {
   }
 
   init_reti();
+  if (mem_stats_active) {
+    init_mem_stats();
+  }
+  if (cache_active) {
+    init_cache();
+  }
+  if (timing_active) {
+    init_timing();
+  }
+  if (branch_pred_active) {
+    init_branch_pred();
+  }
+  // also seeds the random number generator of the machine
+  init_record();
+  if (debug_mode) {
+    init_breakpoints();
+    init_watchpoints();
+  }
+  if (debug_script_active) {
+    init_debug_script();
+  }
+  if (dap_active) {
+    init_dap();
+  }
   if (!legacy_debug_tui) {
     init_tui();
   }
 
-  if (strcmp(isrs_prgrm_path, "") != 0) {
-    error_context.filename = isrs_prgrm_path;
-    parse_and_load_program(get_prgrm_content(isrs_prgrm_path), ISR_PRGRMS);
+  if (strcmp(load_snapshot_path, "") != 0) {
+    load_snapshot(load_snapshot_path);
+  } else {
+    if (strcmp(isrs_prgrm_path, "") != 0) {
+      error_context.filename = isrs_prgrm_path;
+      parse_and_load_program(get_prgrm_content(isrs_prgrm_path), ISR_PRGRMS);
+    }
+
+    error_context.filename = sram_prgrm_path;
+    parse_and_load_program(get_prgrm_content(sram_prgrm_path), SRAM_PRGRM);
+
+    if (strcmp(eprom_prgrm_path, "") != 0) {
+      error_context.filename = eprom_prgrm_path;
+      parse_and_load_program(get_prgrm_content(eprom_prgrm_path),
+                             EPROM_START_PRGRM);
+    } else {
+      load_adjusted_eprom_prgrm();
+    }
   }
 
-  error_context.filename = sram_prgrm_path;
-  parse_and_load_program(get_prgrm_content(sram_prgrm_path), SRAM_PRGRM);
+  if (strcmp(save_snapshot_path, "") != 0) {
+    save_snapshot(save_snapshot_path);
+  }
+  if (debug_mode) {
+    init_restart_snapshot();
+    init_undo();
+  }
+  // after loading, so that errors in the programs don't wait for GDB
+  if (gdb_active) {
+    init_gdb_stub();
+  }
 
-  if (strcmp(eprom_prgrm_path, "") != 0) {
-    error_context.filename = eprom_prgrm_path;
-    parse_and_load_program(get_prgrm_content(eprom_prgrm_path),
-                           EPROM_START_PRGRM);
-  } else {
-    load_adjusted_eprom_prgrm();
+  if (trace_active) {
+    init_trace();
+  }
+  if (pipeline_active) {
+    init_pipeline();
+  }
+  if (shm_export_active) {
+    init_shm_export();
   }
 
   interpr_prgrm();
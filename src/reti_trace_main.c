@@ -0,0 +1,119 @@
+#include "../include/assemble.h"
+#include "../include/debug.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include "../include/trace.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+void print_trace_help(char *bin_name) {
+  fprintf(stderr,
+          "Usage: %s -f from_pc -t to_pc -o mnemonic -b (binary mode) "
+          "-h (help page) trace_path\n",
+          bin_name);
+}
+
+uint32_t parse_pc(char *str, char *bin_name) {
+  char *endptr;
+  int64_t tmp_val = strtoll(str, &endptr, 10);
+  if (endptr == str || *endptr != '\0' || tmp_val < 0 ||
+      tmp_val > UINT32_MAX) {
+    fprintf(stderr, "Error: PC must be between 0 and 4294967295\n");
+    print_trace_help(bin_name);
+    exit(EXIT_FAILURE);
+  }
+  return tmp_val;
+}
+
+bool mnemonic_matches(const char *instr_str, const char *mnemonic) {
+  size_t len = strlen(mnemonic);
+  return strncmp(instr_str, mnemonic, len) == 0 &&
+         (instr_str[len] == ' ' || instr_str[len] == '\0');
+}
+
+void print_trace_record(uint64_t idx, Trace_Record *record) {
+  Instruction *instr = machine_to_assembly(record->machine_instr);
+  char *instr_str = assembly_to_str(instr);
+  printf("%" PRIu64 " %u: %s", idx, record->pc, instr_str);
+  free(instr_str);
+  free(instr);
+  for (uint8_t i = 1; i < NUM_REGISTERS; i++) {
+    if (record->changed_regs & (1 << i)) {
+      printf(" %s=%d", register_code_to_name[i], record->regs[i]);
+    }
+  }
+  for (uint8_t i = 0; i < record->num_mem_writes; i++) {
+    printf(" M[%u]=%d", record->mem_writes[i].addr,
+           record->mem_writes[i].value);
+  }
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t from_pc = 0;
+  uint32_t to_pc = UINT32_MAX;
+  char *mnemonic = NULL;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "f:t:o:bh")) != -1) {
+    switch (opt) {
+    case 'f':
+      from_pc = parse_pc(optarg, argv[0]);
+      break;
+    case 't':
+      to_pc = parse_pc(optarg, argv[0]);
+      break;
+    case 'o':
+      mnemonic = optarg;
+      break;
+    case 'b':
+      binary_mode = true;
+      break;
+    case 'h':
+      print_trace_help(argv[0]);
+      exit(EXIT_SUCCESS);
+    default:
+      print_trace_help(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (optind >= argc) {
+    fprintf(stderr, "Expected argument after options\n");
+    print_trace_help(argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  Trace_Reader reader;
+  if (!open_trace_reader(&reader, argv[optind])) {
+    fprintf(stderr, "Error: %s is not a readable trace file\n", argv[optind]);
+    exit(EXIT_FAILURE);
+  }
+
+  Trace_Record record;
+  uint64_t idx = 0;
+  while (read_trace_record(&reader, &record)) {
+    if (from_pc <= record.pc && record.pc <= to_pc) {
+      if (mnemonic) {
+        Instruction *instr = machine_to_assembly(record.machine_instr);
+        char *instr_str = assembly_to_str(instr);
+        bool matches = mnemonic_matches(instr_str, mnemonic);
+        free(instr_str);
+        free(instr);
+        if (!matches) {
+          idx++;
+          continue;
+        }
+      }
+      print_trace_record(idx, &record);
+    }
+    idx++;
+  }
+
+  close_trace_reader(&reader);
+  return 0;
+}
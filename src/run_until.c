@@ -0,0 +1,112 @@
+#include "../include/run_until.h"
+#include "../include/assemble.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/reti.h"
+#include "../include/uart.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <strings.h>
+
+bool run_until_active = false;
+
+static Until_Kind until_kind;
+// the number of steps, the PC, the register or the counter value at the start
+static uint64_t until_target;
+static uint32_t until_start_value;
+
+static bool parse_number(const char *str, uint64_t *value) {
+  char *endptr;
+  *value = strtoull(str, &endptr, 10);
+  return endptr != str && *endptr == '\0' && *str != '-' &&
+         *value <= UINT32_MAX;
+}
+
+bool parse_num_steps(const char *str) {
+  uint64_t num_steps;
+  if (!parse_number(str, &num_steps) || num_steps == 0) {
+    return false;
+  }
+  until_kind = UNTIL_STEPS;
+  until_target = num_executed_instrs + num_steps;
+  run_until_active = true;
+  return true;
+}
+
+// n and a number of steps, p and a PC, r and a register, o for the next
+// output of the UART or i for the return of the next isr
+bool parse_run_until(const char *str) {
+  uint64_t value;
+  switch (str[0]) {
+  case 'n':
+    return str[1] == ' ' && parse_num_steps(str + 2);
+  case 'p':
+    if (str[1] != ' ' || !parse_number(str + 2, &value)) {
+      return false;
+    }
+    until_kind = UNTIL_PC;
+    until_target = value;
+    break;
+  case 'r': {
+    if (str[1] != ' ') {
+      return false;
+    }
+    uint8_t reg = PC;
+    while (reg <= DS && strcasecmp(str + 2, register_code_to_name[reg]) != 0) {
+      reg++;
+    }
+    if (reg > DS) {
+      return false;
+    }
+    until_kind = UNTIL_REG_CHANGE;
+    until_target = reg;
+    until_start_value = regs[reg];
+    break;
+  }
+  case 'o':
+    if (str[1] != '\0') {
+      return false;
+    }
+    until_kind = UNTIL_UART_OUTPUT;
+    until_target = num_uart_outputs;
+    break;
+  case 'i':
+    if (str[1] != '\0') {
+      return false;
+    }
+    until_kind = UNTIL_ISR_RETURN;
+    until_target = num_isr_returns;
+    break;
+  default:
+    return false;
+  }
+  run_until_active = true;
+  return true;
+}
+
+// called before each instruction, so the first check already happens after
+// the instruction at which the command was given
+void check_run_until() {
+  bool reached;
+  switch (until_kind) {
+  case UNTIL_STEPS:
+    reached = num_executed_instrs >= until_target;
+    break;
+  case UNTIL_PC:
+    reached = regs[PC] == until_target;
+    break;
+  case UNTIL_REG_CHANGE:
+    reached = regs[until_target] != until_start_value;
+    break;
+  case UNTIL_UART_OUTPUT:
+    reached = num_uart_outputs != until_target;
+    break;
+  default: // UNTIL_ISR_RETURN
+    reached = num_isr_returns != until_target;
+    break;
+  }
+  if (reached) {
+    run_until_active = false;
+    breakpoint_encountered = true;
+  }
+}
@@ -0,0 +1,92 @@
+#include "../include/shm_export.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/timing.h"
+#include "../include/uart.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool shm_export_active = false;
+char *shm_export_name = "";
+
+#ifdef _WIN32
+void init_shm_export() {
+  fprintf(stderr, "Error: Shared memory isn't supported on Windows\n");
+  exit(EXIT_FAILURE);
+}
+
+void publish_shm_state() {}
+
+void check_shm_export() {}
+
+void fin_shm_export() {}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static Shm_State *shm_state;
+static uint32_t instrs_since_update = 0;
+static bool program_finished = false;
+
+void init_shm_export() {
+  if (shm_export_name[0] != '/' || strchr(shm_export_name + 1, '/')) {
+    fprintf(stderr, "Error: Name of the shared memory has to be like /reti\n");
+    exit(EXIT_FAILURE);
+  }
+  int fd = shm_open(shm_export_name, O_CREAT | O_RDWR, 0644);
+  if (fd < 0 || ftruncate(fd, sizeof(Shm_State)) != 0) {
+    perror("Error: Failed to create the shared memory");
+    exit(EXIT_FAILURE);
+  }
+  shm_state = mmap(NULL, sizeof(Shm_State), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm_state == MAP_FAILED) {
+    perror("Error: Failed to map the shared memory");
+    exit(EXIT_FAILURE);
+  }
+  memset(shm_state, 0, sizeof(Shm_State));
+  shm_state->magic = SHM_EXPORT_MAGIC;
+  shm_state->version = SHM_EXPORT_VERSION;
+  publish_shm_state();
+}
+
+void publish_shm_state() {
+  uint64_t seq = atomic_load_explicit(&shm_state->seq, memory_order_relaxed);
+  atomic_store_explicit(&shm_state->seq, seq + 1, memory_order_relaxed);
+  // the odd seq has to be visible before any of the new values
+  atomic_thread_fence(memory_order_release);
+  memcpy(shm_state->regs, regs, sizeof(shm_state->regs));
+  memcpy(shm_state->uart, uart, sizeof(shm_state->uart));
+  memcpy(shm_state->isr_priority_stack, isr_priority_stack,
+         sizeof(shm_state->isr_priority_stack));
+  shm_state->stack_top = stack_top;
+  shm_state->current_isr = current_isr;
+  shm_state->isr_active = isr_active;
+  shm_state->finished = program_finished;
+  shm_state->num_executed_instrs = num_executed_instrs;
+  shm_state->num_isr_returns = num_isr_returns;
+  shm_state->cycles = cycles;
+  atomic_store_explicit(&shm_state->seq, seq + 2, memory_order_release);
+}
+
+// called by the emulator before each instruction, so the common case has to be
+// a counter
+void check_shm_export() {
+  if (++instrs_since_update < SHM_UPDATE_INTERVAL) {
+    return;
+  }
+  instrs_since_update = 0;
+  publish_shm_state();
+}
+
+// viewers that are attached keep the final state, new ones can't attach
+void fin_shm_export() {
+  program_finished = true;
+  publish_shm_state();
+  munmap(shm_state, sizeof(Shm_State));
+  shm_unlink(shm_export_name);
+}
+#endif
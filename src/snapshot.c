@@ -0,0 +1,324 @@
+#include "../include/snapshot.h"
+#include "../include/assemble.h"
+#include "../include/datastructures.h"
+#include "../include/debug.h"
+#include "../include/disasm_cache.h"
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/parse_args.h"
+#include "../include/record.h"
+#include "../include/reti.h"
+#include "../include/uart.h"
+#include "../include/undo.h"
+#include "../include/utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+char *save_snapshot_path = "";
+char *load_snapshot_path = "";
+
+bool restart_snapshot_active = false;
+// bit set means the page was already copied since the last restart
+uint8_t *restart_dirty_pages = NULL;
+// the SRAM and the cells that were written behind its end while loading,
+// writes behind these are undone by cutting sram.bin back to them
+uint32_t restart_tracked_cells = 0;
+
+static Snapshot restart_snapshot = {.without_sram = true};
+// original content of the SRAM pages, copied before their first write
+static uint8_t **original_pages = NULL;
+static uint32_t *dirty_page_list = NULL;
+static uint32_t num_dirty_pages = 0;
+
+#define PUT(snapshot, value) snapshot_put(snapshot, &(value), sizeof(value))
+#define GET(snapshot, value) snapshot_get(snapshot, &(value), sizeof(value))
+
+static void reserve(Snapshot *snapshot, size_t len) {
+  if (snapshot->len + len > snapshot->capacity) {
+    size_t capacity = snapshot->capacity ? snapshot->capacity : 4096;
+    while (snapshot->len + len > capacity) {
+      capacity *= 2;
+    }
+    uint8_t *data = realloc(snapshot->data, capacity);
+    if (!data) {
+      fprintf(stderr, "Error: Failed to allocate memory for the snapshot\n");
+      exit(EXIT_FAILURE);
+    }
+    snapshot->data = data;
+    snapshot->capacity = capacity;
+  }
+}
+
+void snapshot_put(Snapshot *snapshot, const void *value, size_t len) {
+  reserve(snapshot, len);
+  memcpy(snapshot->data + snapshot->len, value, len);
+  snapshot->len += len;
+}
+
+bool snapshot_get(Snapshot *snapshot, void *value, size_t len) {
+  if (snapshot->pos + len > snapshot->len) {
+    return false;
+  }
+  memcpy(value, snapshot->data + snapshot->pos, len);
+  snapshot->pos += len;
+  return true;
+}
+
+static void put_sram(Snapshot *snapshot) {
+  fflush(sram);
+  fseek(sram, 0, SEEK_END);
+  uint64_t sram_len = ftell(sram);
+  PUT(snapshot, sram_len);
+  // the file is read directly into the snapshot
+  reserve(snapshot, sram_len);
+  fseek(sram, 0, SEEK_SET);
+  if (fread(snapshot->data + snapshot->len, 1, sram_len, sram) != sram_len) {
+    fprintf(stderr, "Error: Failed to read the SRAM for the snapshot\n");
+    exit(EXIT_FAILURE);
+  }
+  snapshot->len += sram_len;
+}
+
+static bool get_sram(Snapshot *snapshot) {
+  uint64_t sram_len;
+  if (!GET(snapshot, sram_len) || snapshot->pos + sram_len > snapshot->len) {
+    return false;
+  }
+  fseek(sram, 0, SEEK_END);
+  uint64_t old_sram_len = ftell(sram);
+  fseek(sram, 0, SEEK_SET);
+  fwrite(snapshot->data + snapshot->pos, 1, sram_len, sram);
+  snapshot->pos += sram_len;
+  // what was written after the snapshot was taken has to read as 0 again
+  if (old_sram_len > sram_len) {
+    uint8_t *zeros = calloc(old_sram_len - sram_len, 1);
+    fwrite(zeros, 1, old_sram_len - sram_len, sram);
+    free(zeros);
+  }
+  fflush(sram);
+  clear_disasm_cache();
+  return true;
+}
+
+// everything that changes while a program runs, the options and the input
+// from the metadata of the program belong to the current run instead
+void take_snapshot(Snapshot *snapshot) {
+  snapshot->len = 0;
+  snapshot_put(snapshot, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN);
+  uint32_t header[] = {SNAPSHOT_VERSION, SNAPSHOT_BYTE_ORDER_MARK, sram_size};
+  PUT(snapshot, header);
+
+  snapshot_put(snapshot, regs, sizeof(uint32_t) * NUM_REGISTERS);
+  PUT(snapshot, num_instrs_start_prgrm);
+  snapshot_put(snapshot, eprom, sizeof(uint32_t) * num_instrs_start_prgrm);
+  PUT(snapshot, num_instrs_prgrm);
+  PUT(snapshot, num_instrs_isrs);
+  PUT(snapshot, ivt_max_idx);
+  if (!snapshot->without_sram) {
+    put_sram(snapshot);
+  }
+
+  save_uart_state(snapshot);
+
+  PUT(snapshot, timer_cnt);
+  PUT(snapshot, interrupt_timer_active);
+  PUT(snapshot, keypress_interrupt_active);
+  PUT(snapshot, keypress_interrupt_activatable);
+  PUT(snapshot, prng_state);
+
+  PUT(snapshot, device_to_isr);
+  PUT(snapshot, isr_num);
+  snapshot_put(snapshot, isr_to_prio, isr_num);
+  PUT(snapshot, isr_of_timer_interrupt);
+  PUT(snapshot, isr_of_keypress_interrupt);
+  PUT(snapshot, isr_priority_stack);
+  PUT(snapshot, stack_top);
+  snapshot_put(snapshot, isr_heap, HEAP_SIZE);
+  PUT(snapshot, heap_size);
+
+  PUT(snapshot, current_isr);
+  PUT(snapshot, breakpoint_encountered);
+  PUT(snapshot, isr_finished);
+  PUT(snapshot, step_into_activated);
+  PUT(snapshot, isr_active);
+  PUT(snapshot, restore_isr_active);
+  PUT(snapshot, restore_step_into_activated);
+  PUT(snapshot, restore_isr_finished);
+}
+
+static bool get_header(Snapshot *snapshot) {
+  char magic[SNAPSHOT_MAGIC_LEN];
+  uint32_t header[3];
+  if (!snapshot_get(snapshot, magic, SNAPSHOT_MAGIC_LEN) ||
+      memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0 ||
+      !GET(snapshot, header) || header[0] != SNAPSHOT_VERSION ||
+      header[1] != SNAPSHOT_BYTE_ORDER_MARK) {
+    return false;
+  }
+  if (header[2] != sram_size) {
+    fprintf(stderr, "Error: Snapshot was taken with SRAM size %u\n",
+            header[2]);
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+// returns false if the snapshot is invalid, the state is undefined then
+bool restore_snapshot(Snapshot *snapshot) {
+  snapshot->pos = 0;
+  if (!get_header(snapshot)) {
+    return false;
+  }
+
+  if (!snapshot_get(snapshot, regs, sizeof(uint32_t) * NUM_REGISTERS) ||
+      !GET(snapshot, num_instrs_start_prgrm)) {
+    return false;
+  }
+  eprom = realloc(eprom, sizeof(uint32_t) * (num_instrs_start_prgrm + 1));
+  if (!snapshot_get(snapshot, eprom,
+                    sizeof(uint32_t) * num_instrs_start_prgrm) ||
+      !GET(snapshot, num_instrs_prgrm) || !GET(snapshot, num_instrs_isrs) ||
+      !GET(snapshot, ivt_max_idx) ||
+      (!snapshot->without_sram && !get_sram(snapshot))) {
+    return false;
+  }
+
+  if (!restore_uart_state(snapshot)) {
+    return false;
+  }
+
+  if (!GET(snapshot, timer_cnt) || !GET(snapshot, interrupt_timer_active) ||
+      !GET(snapshot, keypress_interrupt_active) ||
+      !GET(snapshot, keypress_interrupt_activatable) ||
+      !GET(snapshot, prng_state)) {
+    return false;
+  }
+
+  if (!GET(snapshot, device_to_isr) || !GET(snapshot, isr_num)) {
+    return false;
+  }
+  isr_to_prio = realloc(isr_to_prio, isr_num + 1);
+  if (!snapshot_get(snapshot, isr_to_prio, isr_num) ||
+      !GET(snapshot, isr_of_timer_interrupt) ||
+      !GET(snapshot, isr_of_keypress_interrupt) ||
+      !GET(snapshot, isr_priority_stack) || !GET(snapshot, stack_top) ||
+      !snapshot_get(snapshot, isr_heap, HEAP_SIZE) ||
+      !GET(snapshot, heap_size)) {
+    return false;
+  }
+
+  return GET(snapshot, current_isr) &&
+         GET(snapshot, breakpoint_encountered) &&
+         GET(snapshot, isr_finished) && GET(snapshot, step_into_activated) &&
+         GET(snapshot, isr_active) && GET(snapshot, restore_isr_active) &&
+         GET(snapshot, restore_step_into_activated) &&
+         GET(snapshot, restore_isr_finished);
+}
+
+void free_snapshot(Snapshot *snapshot) {
+  free(snapshot->data);
+  *snapshot = (Snapshot){0};
+}
+
+void save_snapshot(const char *path) {
+  Snapshot snapshot = {0};
+  take_snapshot(&snapshot);
+  FILE *file = fopen(path, "wb");
+  if (!file || fwrite(snapshot.data, 1, snapshot.len, file) != snapshot.len) {
+    fprintf(stderr, "Error: Can't write snapshot %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  fclose(file);
+  free_snapshot(&snapshot);
+}
+
+void load_snapshot(const char *path) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "Error: Can't open snapshot %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  Snapshot snapshot = {0};
+  fseek(file, 0, SEEK_END);
+  snapshot.len = snapshot.capacity = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  snapshot.data = malloc(snapshot.len + 1);
+  if (!snapshot.data ||
+      fread(snapshot.data, 1, snapshot.len, file) != snapshot.len) {
+    fprintf(stderr, "Error: Can't read snapshot %s\n", path);
+    exit(EXIT_FAILURE);
+  }
+  fclose(file);
+  if (!restore_snapshot(&snapshot)) {
+    fprintf(stderr, "Error: %s is not a valid snapshot of this version\n",
+            path);
+    exit(EXIT_FAILURE);
+  }
+  free_snapshot(&snapshot);
+}
+
+// the debugger restarts from the state right after loading, the SRAM pages
+// are only copied when they are written to for the first time, so that a
+// restart only costs as much as the pages that were actually changed
+void init_restart_snapshot() {
+  take_snapshot(&restart_snapshot);
+  fseek(sram, 0, SEEK_END);
+  restart_tracked_cells = max(sram_size, ftell(sram) / sizeof(uint32_t));
+  uint32_t num_pages =
+      ((uint64_t)restart_tracked_cells + page_size - 1) / page_size;
+  restart_dirty_pages = calloc((num_pages + 7) / 8, 1);
+  original_pages = calloc(num_pages, sizeof(uint8_t *));
+  dirty_page_list = malloc(sizeof(uint32_t) * num_pages);
+  if (!restart_dirty_pages || !original_pages || !dirty_page_list) {
+    fprintf(stderr, "Error: Failed to allocate the restart snapshot\n");
+    exit(EXIT_FAILURE);
+  }
+  restart_snapshot_active = true;
+}
+
+void save_page_before_write(uint32_t page) {
+  restart_dirty_pages[page / 8] |= 1 << (page % 8);
+  dirty_page_list[num_dirty_pages++] = page;
+  if (original_pages[page]) {
+    // still holds the original content from an earlier restart
+    return;
+  }
+  original_pages[page] = calloc(page_size, sizeof(uint32_t));
+  if (!original_pages[page]) {
+    fprintf(stderr, "Error: Failed to allocate the restart snapshot\n");
+    exit(EXIT_FAILURE);
+  }
+  // parts of the page behind the end of the file stay 0
+  fseek(sram, (uint64_t)page * page_size * sizeof(uint32_t), SEEK_SET);
+  fread(original_pages[page], sizeof(uint32_t), page_size, sram);
+}
+
+void restart_from_snapshot() {
+  for (uint32_t i = 0; i < num_dirty_pages; i++) {
+    uint32_t page = dirty_page_list[i];
+    uint64_t page_start = (uint64_t)page * page_size;
+    uint32_t len = min(page_size, restart_tracked_cells - page_start);
+    fseek(sram, page_start * sizeof(uint32_t), SEEK_SET);
+    fwrite(original_pages[page], sizeof(uint32_t), len, sram);
+    restart_dirty_pages[page / 8] &= ~(1 << (page % 8));
+  }
+  fflush(sram);
+  off_t tracked_len = (off_t)restart_tracked_cells * sizeof(uint32_t);
+  fseek(sram, 0, SEEK_END);
+  if (ftell(sram) > tracked_len && ftruncate(fileno(sram), tracked_len) != 0) {
+    perror("Error: Failed to restore the SRAM");
+    exit(EXIT_FAILURE);
+  }
+  clear_disasm_cache();
+  num_dirty_pages = 0;
+  restore_snapshot(&restart_snapshot);
+  // the inputs from the metadata of the program start from the beginning
+  input_idx = 0;
+  if (undo_active) {
+    clear_undo_log();
+  }
+}
@@ -1,7 +1,19 @@
 #include "../include/special_opts.h"
+#include "../include/arena.h"
+#include "../include/branch_pred.h"
+#include "../include/cache.h"
+#include "../include/dap.h"
+#include "../include/live_view.h"
 #include "../include/debug.h"
 #include "../include/error.h"
+#include "../include/gdb_stub.h"
+#include "../include/mem_stats.h"
 #include "../include/parse_args.h"
+#include "../include/pipeline.h"
+#include "../include/protocol.h"
+#include "../include/record.h"
+#include "../include/shm_export.h"
+#include "../include/timing.h"
 #include "../include/utils.h"
 #include "../include/reti.h"
 #include <ctype.h>
@@ -134,6 +146,19 @@ void adjust_print(bool is_stdout, const char *format,
     } else {
       vfprintf(err_file, format, args);
     }
+  } else if (protocol_active && is_stdout) {
+    // the output of the program mustn't get between the lines of the protocol
+    if (format != NULL) {
+      char output[MAX_LEN_PROTOCOL_MESSAGE + 1];
+      vsnprintf(output, sizeof(output), format, args);
+      send_protocol_message("output", output);
+    }
+  } else if (dap_active && is_stdout) {
+    if (format != NULL) {
+      char output[MAX_LEN_DAP_OUTPUT + 1];
+      vsnprintf(output, sizeof(output), format, args);
+      send_dap_output("stdout", output);
+    }
   } else {
     if (is_stdout) { // because of display_error_message in case test_mode is
                      // false
@@ -154,11 +179,42 @@ void close_out_and_err_file() {
 }
 
 void finalize() {
-  fin_reti();
+  stop_live_view();
   if (!legacy_debug_tui) {
     fin_tui();
   }
   if (test_mode) {
     close_out_and_err_file();
   }
+  if (mem_stats_active) {
+    print_mem_stats();
+  }
+  if (cache_active) {
+    print_cache_stats();
+  }
+  if (branch_pred_active) {
+    print_branch_pred_stats();
+  }
+  if (timing_active) {
+    print_timing_stats();
+  }
+  if (pipeline_active) {
+    print_pipeline_stats();
+  }
+  if (record_active || replay_active) {
+    fin_record();
+  }
+  if (protocol_active) {
+    fin_protocol();
+  } else if (dap_active) {
+    fin_dap();
+  } else if (gdb_active) {
+    fin_gdb_stub();
+  }
+  if (shm_export_active) {
+    fin_shm_export();
+  }
+  // after the statistics, because they disassemble instructions in the SRAM
+  fin_reti();
+  fin_frame_arena();
 }
@@ -0,0 +1,166 @@
+#include "../include/timing.h"
+#include "../include/assemble.h"
+#include "../include/reti.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool timing_active = false;
+char *timing_path = "";
+
+// without a config file every instruction takes one cycle and memory
+// accesses are free, which is the same as counting instructions
+uint32_t latencies[NUM_LATENCIES] = {1, 1, 1, 1, 1, 1, 1, 1,
+                                     1, 1, 1, 0, 0, 0, 0, 0};
+uint64_t cycles = 0;
+// cycles of the instruction that is currently being executed
+uint32_t instr_cycles = 0;
+
+static const char *latency_to_name[] = {
+    "compute_i", "compute_r", "compute_m", "load",  "loadi",
+    "store",     "move",      "nop",       "int",   "rti",
+    "jump",      "eprom",     "uart",      "sram",  "cache_hit",
+    "mispredict"};
+
+static uint64_t class_instrs[NUM_INSTR_CLASSES];
+static uint64_t class_cycles[NUM_INSTR_CLASSES];
+static uint64_t mem_cycles = 0;
+static uint64_t penalty_cycles = 0;
+
+// one "name value" pair per line, # starts a comment
+void init_timing() {
+  FILE *file = fopen(timing_path, "r");
+  if (!file) {
+    fprintf(stderr, "Error: Can't open timing config %s\n", timing_path);
+    exit(EXIT_FAILURE);
+  }
+
+  char line[256];
+  uint32_t line_num = 0;
+  while (fgets(line, sizeof(line), file)) {
+    line_num++;
+    char *comment = strchr(line, '#');
+    if (comment) {
+      *comment = '\0';
+    }
+    char name[32];
+    long long value;
+    char rest;
+    int num_matched = sscanf(line, "%31s %lld %c", name, &value, &rest);
+    if (num_matched <= 0) {
+      continue;
+    }
+    if (num_matched != 2 || value < 0 || value > UINT32_MAX) {
+      fprintf(stderr, "Error: Expected name and latency in line %u of %s\n",
+              line_num, timing_path);
+      exit(EXIT_FAILURE);
+    }
+    uint8_t i = 0;
+    while (i < NUM_LATENCIES && strcmp(name, latency_to_name[i]) != 0) {
+      i++;
+    }
+    if (i == NUM_LATENCIES) {
+      fprintf(stderr, "Error: Unknown latency %s in line %u of %s\n", name,
+              line_num, timing_path);
+      exit(EXIT_FAILURE);
+    }
+    latencies[i] = value;
+  }
+  fclose(file);
+}
+
+Latency instr_class_of_op(uint8_t op) {
+  if (op <= ANDI) {
+    return TIMING_COMPUTE_I;
+  } else if (op <= ANDR) {
+    return TIMING_COMPUTE_R;
+  } else if (op <= ANDM) {
+    return TIMING_COMPUTE_M;
+  }
+  switch (op) {
+  case LOAD:
+  case LOADIN:
+    return TIMING_LOAD;
+  case LOADI:
+    return TIMING_LOADI;
+  case STORE:
+  case STOREIN:
+    return TIMING_STORE;
+  case MOVE:
+    return TIMING_MOVE;
+  case INT:
+    return TIMING_INT;
+  case RTI:
+    return TIMING_RTI;
+  case NOP:
+    return TIMING_NOP;
+  default: // JUMP family
+    return TIMING_JUMP;
+  }
+}
+
+void timing_mem_access(uint32_t addr, bool cache_hit) {
+  uint32_t latency;
+  if (cache_hit) {
+    latency = latencies[TIMING_CACHE_HIT];
+  } else {
+    switch (addr >> 30) {
+    case EPROM_CONST:
+      latency = latencies[TIMING_EPROM];
+      break;
+    case UART_CONST:
+      latency = latencies[TIMING_UART];
+      break;
+    default: // SRAM_CONST
+      latency = latencies[TIMING_SRAM];
+      break;
+    }
+  }
+  instr_cycles += latency;
+  mem_cycles += latency;
+  cycles += latency;
+}
+
+void timing_penalty(uint32_t penalty) {
+  instr_cycles += penalty;
+  penalty_cycles += penalty;
+  cycles += penalty;
+}
+
+void timing_instr_begin() { instr_cycles = 0; }
+
+void timing_instr_end(uint8_t op) {
+  Latency instr_class = instr_class_of_op(op);
+  instr_cycles += latencies[instr_class];
+  class_instrs[instr_class]++;
+  class_cycles[instr_class] += instr_cycles;
+  cycles += latencies[instr_class];
+}
+
+// how far the timer and the UART advance during one instruction
+uint32_t elapsed_ticks() { return timing_active ? instr_cycles : 1; }
+
+void print_timing_stats() {
+  uint64_t num_instrs = 0;
+  for (uint8_t i = 0; i < NUM_INSTR_CLASSES; i++) {
+    num_instrs += class_instrs[i];
+  }
+  fprintf(stderr, "Timing (%s):\n", timing_path);
+  for (uint8_t i = 0; i < NUM_INSTR_CLASSES; i++) {
+    if (class_instrs[i] > 0) {
+      fprintf(stderr,
+              "  %-10s %10" PRIu64 " instructions %12" PRIu64 " cycles\n",
+              latency_to_name[i], class_instrs[i], class_cycles[i]);
+    }
+  }
+  fprintf(stderr,
+          "  %" PRIu64 " cycles, thereof %" PRIu64
+          " for memory accesses and %" PRIu64 " for mispredictions\n",
+          cycles, mem_cycles, penalty_cycles);
+  if (num_instrs > 0) {
+    fprintf(stderr, "  %" PRIu64 " instructions, CPI %.3f\n", num_instrs,
+            (double)cycles / num_instrs);
+  }
+}
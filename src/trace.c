@@ -0,0 +1,273 @@
+#include "../include/trace.h"
+#include "../include/assemble.h"
+#include "../include/reti.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool trace_active = false;
+bool trace_delta = false;
+char *trace_path = "";
+
+static FILE *trace_file = NULL;
+static uint8_t *trace_buffer = NULL;
+static size_t trace_buffer_len = 0;
+
+static Trace_Record current_record;
+static uint32_t prev_pc;
+static uint32_t prev_mem_addr = 0;
+
+static void flush_trace_buffer() {
+  if (trace_buffer_len > 0) {
+    fwrite(trace_buffer, 1, trace_buffer_len, trace_file);
+    trace_buffer_len = 0;
+  }
+}
+
+static void put_u32(uint32_t value) {
+  trace_buffer[trace_buffer_len++] = value & 0xFF;
+  trace_buffer[trace_buffer_len++] = (value >> 8) & 0xFF;
+  trace_buffer[trace_buffer_len++] = (value >> 16) & 0xFF;
+  trace_buffer[trace_buffer_len++] = (value >> 24) & 0xFF;
+}
+
+// zigzag maps small negative and positive differences to small unsigned
+// numbers, so that the varint afterwards only needs one or two bytes
+static void put_varint(int32_t value) {
+  uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+  while (zigzag >= 0x80) {
+    trace_buffer[trace_buffer_len++] = (zigzag & 0x7F) | 0x80;
+    zigzag >>= 7;
+  }
+  trace_buffer[trace_buffer_len++] = zigzag;
+}
+
+static void put_value(uint32_t value, uint32_t reference) {
+  if (trace_delta) {
+    put_varint((int32_t)(value - reference));
+  } else {
+    put_u32(value);
+  }
+}
+
+void init_trace() {
+  trace_file = fopen(trace_path, "wb");
+  if (!trace_file) {
+    fprintf(stderr, "Error: Can't open trace file %s\n", trace_path);
+    exit(EXIT_FAILURE);
+  }
+  trace_buffer = malloc(TRACE_BUFFER_SIZE);
+
+  memcpy(trace_buffer, TRACE_MAGIC, TRACE_MAGIC_LEN);
+  trace_buffer_len = TRACE_MAGIC_LEN;
+  trace_buffer[trace_buffer_len++] = TRACE_VERSION;
+  trace_buffer[trace_buffer_len++] = trace_delta ? TRACE_HEADER_DELTA : 0;
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    put_u32(regs[i]);
+  }
+  memcpy(current_record.regs, regs, sizeof(uint32_t) * NUM_REGISTERS);
+  prev_pc = regs[PC] - 1;
+  prev_mem_addr = 0;
+
+  // the error exits of the interpreter don't pass through finalize, but the
+  // trace is most interesting exactly in these cases
+  atexit(fin_trace);
+}
+
+void trace_instr_begin(uint32_t pc, uint32_t machine_instr) {
+  current_record.pc = pc;
+  current_record.machine_instr = machine_instr;
+  current_record.num_mem_writes = 0;
+}
+
+void trace_mem_write(uint32_t addr, uint32_t value) {
+  if (current_record.num_mem_writes < MAX_TRACE_MEM_WRITES) {
+    current_record.mem_writes[current_record.num_mem_writes++] =
+        (Trace_Mem_Write){addr, value};
+  }
+}
+
+void trace_instr_end() {
+  uint8_t changed_regs = 0;
+  for (uint8_t i = 1; i < NUM_REGISTERS; i++) {
+    if (regs[i] != current_record.regs[i]) {
+      changed_regs |= 1 << i;
+    }
+  }
+
+  uint8_t flags = 0;
+  if (changed_regs) {
+    flags |= TRACE_REGS_CHANGED;
+  }
+  if (current_record.num_mem_writes > 0) {
+    flags |= TRACE_MEM_WRITTEN;
+  }
+  if (trace_delta && current_record.pc == prev_pc + 1) {
+    flags |= TRACE_PC_SEQUENTIAL;
+  }
+
+  if (trace_buffer_len + MAX_TRACE_RECORD_SIZE > TRACE_BUFFER_SIZE) {
+    flush_trace_buffer();
+  }
+
+  trace_buffer[trace_buffer_len++] = flags;
+  if (!(flags & TRACE_PC_SEQUENTIAL)) {
+    put_value(current_record.pc, prev_pc + 1);
+  }
+  put_u32(current_record.machine_instr);
+
+  if (changed_regs) {
+    trace_buffer[trace_buffer_len++] = changed_regs;
+    for (uint8_t i = 1; i < NUM_REGISTERS; i++) {
+      if (changed_regs & (1 << i)) {
+        put_value(regs[i], current_record.regs[i]);
+        current_record.regs[i] = regs[i];
+      }
+    }
+  }
+
+  if (current_record.num_mem_writes > 0) {
+    trace_buffer[trace_buffer_len++] = current_record.num_mem_writes;
+    for (uint8_t i = 0; i < current_record.num_mem_writes; i++) {
+      put_value(current_record.mem_writes[i].addr, prev_mem_addr);
+      put_value(current_record.mem_writes[i].value, 0);
+      prev_mem_addr = current_record.mem_writes[i].addr;
+    }
+  }
+
+  prev_pc = current_record.pc;
+}
+
+void fin_trace() {
+  if (!trace_file) {
+    return;
+  }
+  flush_trace_buffer();
+  fclose(trace_file);
+  trace_file = NULL;
+  free(trace_buffer);
+  trace_buffer = NULL;
+}
+
+static bool get_u32(FILE *file, uint32_t *value) {
+  uint8_t bytes[4];
+  if (fread(bytes, 1, 4, file) != 4) {
+    return false;
+  }
+  *value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+  return true;
+}
+
+static bool get_varint(FILE *file, int32_t *value) {
+  uint32_t zigzag = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    int byte = fgetc(file);
+    if (byte == EOF) {
+      return false;
+    }
+    zigzag |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *value = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool get_value(Trace_Reader *reader, uint32_t *value,
+                      uint32_t reference) {
+  if (reader->delta) {
+    int32_t diff;
+    if (!get_varint(reader->file, &diff)) {
+      return false;
+    }
+    *value = reference + diff;
+    return true;
+  }
+  return get_u32(reader->file, value);
+}
+
+bool open_trace_reader(Trace_Reader *reader, const char *path) {
+  reader->file = fopen(path, "rb");
+  if (!reader->file) {
+    return false;
+  }
+  char magic[TRACE_MAGIC_LEN];
+  if (fread(magic, 1, TRACE_MAGIC_LEN, reader->file) != TRACE_MAGIC_LEN ||
+      memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0 ||
+      fgetc(reader->file) != TRACE_VERSION) {
+    fclose(reader->file);
+    return false;
+  }
+  int header_flags = fgetc(reader->file);
+  if (header_flags == EOF) {
+    fclose(reader->file);
+    return false;
+  }
+  reader->delta = header_flags & TRACE_HEADER_DELTA;
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    if (!get_u32(reader->file, &reader->regs[i])) {
+      fclose(reader->file);
+      return false;
+    }
+  }
+  reader->prev_pc = reader->regs[PC] - 1;
+  reader->prev_mem_addr = 0;
+  return true;
+}
+
+bool read_trace_record(Trace_Reader *reader, Trace_Record *record) {
+  int flags = fgetc(reader->file);
+  if (flags == EOF) {
+    return false;
+  }
+
+  if (flags & TRACE_PC_SEQUENTIAL) {
+    record->pc = reader->prev_pc + 1;
+  } else if (!get_value(reader, &record->pc, reader->prev_pc + 1)) {
+    return false;
+  }
+  if (!get_u32(reader->file, &record->machine_instr)) {
+    return false;
+  }
+
+  record->changed_regs = 0;
+  if (flags & TRACE_REGS_CHANGED) {
+    int changed_regs = fgetc(reader->file);
+    if (changed_regs == EOF) {
+      return false;
+    }
+    record->changed_regs = changed_regs;
+    for (uint8_t i = 1; i < NUM_REGISTERS; i++) {
+      if ((changed_regs & (1 << i)) &&
+          !get_value(reader, &reader->regs[i], reader->regs[i])) {
+        return false;
+      }
+    }
+  }
+  memcpy(record->regs, reader->regs, sizeof(uint32_t) * NUM_REGISTERS);
+  record->regs[PC] = record->pc;
+
+  record->num_mem_writes = 0;
+  if (flags & TRACE_MEM_WRITTEN) {
+    int num_mem_writes = fgetc(reader->file);
+    if (num_mem_writes == EOF || num_mem_writes > MAX_TRACE_MEM_WRITES) {
+      return false;
+    }
+    for (uint8_t i = 0; i < num_mem_writes; i++) {
+      Trace_Mem_Write *mem_write = &record->mem_writes[i];
+      if (!get_value(reader, &mem_write->addr, reader->prev_mem_addr) ||
+          !get_value(reader, &mem_write->value, 0)) {
+        return false;
+      }
+      reader->prev_mem_addr = mem_write->addr;
+    }
+    record->num_mem_writes = num_mem_writes;
+  }
+
+  reader->prev_pc = record->pc;
+  return true;
+}
+
+void close_trace_reader(Trace_Reader *reader) { fclose(reader->file); }
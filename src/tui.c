@@ -1,10 +1,13 @@
 #include "../include/tui.h"
+#include "../include/mem_stats.h"
 #include "../include/parse_args.h"
 #include "../include/uart.h"
 #include "../include/utils.h"
 #include <ncurses.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 Box regs_box = {"", 0, 0, 0, 0, 1, 1, NULL};
@@ -14,8 +17,11 @@ Box sram_c_box = {"", 0, 0, 0, 0, 1, 1, NULL};
 Box sram_d_box = {"", 0, 0, 0, 0, 1, 1, NULL};
 Box sram_s_box = {"", 0, 0, 0, 0, 1, 1, NULL};
 Box info_box = {"(n)ext instruction, (c)ontinue to breakpoint, (r)estart, "
-                "(s)tep into isr, (f)inalize isr, (t)rigger isr, "
-                "(a)ssign watchobject reg or addr, (q)uit",
+                "(N) steps, r(u)n until, (s)tep into isr, (f)inalize isr, "
+                "(t)rigger isr, "
+                "step (b)ack, (B)ack to breakpoint, toggle brea(k)point, "
+                "conditional brea(K)point, "
+                "(w)atchpoint, (a)ssign watchobject reg or addr, (q)uit",
                 0,
                 0,
                 0,
@@ -25,23 +31,69 @@ Box info_box = {"(n)ext instruction, (c)ontinue to breakpoint, (r)estart, "
                 NULL};
 
 uint16_t term_width, term_height;
+// without SIGWINCH there is no way to learn about a resize but to look at the
+// size before every frame
+volatile sig_atomic_t term_resized = true;
 
 Box *boxes[] = {&regs_box,   &eprom_box,  &uart_box, &sram_c_box,
                 &sram_d_box, &sram_s_box, &info_box};
 const uint8_t NUM_BOXES = sizeof(boxes) / sizeof(boxes[0]);
 
+#ifdef SIGWINCH
+static void (*ncurses_sigwinch_handler)(int) = SIG_DFL;
+
+static void note_term_resize(int sig) {
+  term_resized = true;
+  if (ncurses_sigwinch_handler != SIG_DFL &&
+      ncurses_sigwinch_handler != SIG_IGN) {
+    ncurses_sigwinch_handler(sig);
+  }
+}
+#endif
+
 void init_tui() {
   initscr();
   cbreak();
   noecho();
   curs_set(0); // Hide cursor
 
+  if (heatmap_active && has_colors()) {
+    start_color();
+    init_pair(1, COLOR_BLUE, COLOR_BLACK);
+    init_pair(2, COLOR_GREEN, COLOR_BLACK);
+    init_pair(3, COLOR_YELLOW, COLOR_BLACK);
+    init_pair(NUM_HEAT_LEVELS, COLOR_RED, COLOR_BLACK);
+  }
+
   for (uint8_t i = 0; i < NUM_BOXES; i++) {
     boxes[i]->win = newwin(1, 1, 0, 0);
+    boxes[i]->rows = calloc(UINT8_MAX + 1, sizeof(Row_Key));
+  }
+
+#ifdef SIGWINCH
+  // Ncurses has its own handler, which makes the next refresh pick up the
+  // new size and getch return KEY_RESIZE, so it's called as well. With
+  // SA_RESTART a resize doesn't make the blocking reads of stdin fail
+  struct sigaction action;
+  sigaction(SIGWINCH, NULL, &action);
+  ncurses_sigwinch_handler = action.sa_handler;
+  action.sa_handler = note_term_resize;
+  action.sa_flags |= SA_RESTART;
+  sigaction(SIGWINCH, &action, NULL);
+#endif
+  update_term_and_box_sizes();
+}
+
+void update_layout_if_resized() {
+  if (term_resized) {
+    update_term_and_box_sizes();
   }
 }
 
 void update_term_and_box_sizes() {
+#ifdef SIGWINCH
+  term_resized = false;
+#endif
   refresh(); // has to be because term_height and term_width can only be
              // determined after refresh
   getmaxyx(stdscr, term_height, term_width);
@@ -91,6 +143,13 @@ void update_term_and_box_sizes() {
   info_box.height = 1;
 
   for (uint8_t i = 0; i < NUM_BOXES; i++) {
+    int old_y, old_x, old_height, old_width;
+    getbegyx(boxes[i]->win, old_y, old_x);
+    getmaxyx(boxes[i]->win, old_height, old_width);
+    if (old_y != boxes[i]->y || old_x != boxes[i]->x ||
+        old_height != boxes[i]->height || old_width != boxes[i]->width) {
+      boxes[i]->needs_erase = true;
+    }
     wresize(boxes[i]->win, boxes[i]->height,
             boxes[i]->width); // Resize the window
     mvwin(boxes[i]->win, boxes[i]->y,
@@ -108,6 +167,14 @@ void fin_tui() {
 
 void draw_boxes() {
   for (uint8_t i = 0; i < NUM_BOXES; i++) {
+    // the lines below the content of this frame still show the last one
+    for (uint8_t line = boxes[i]->line; line < boxes[i]->num_used_lines;
+         line++) {
+      mvwhline(boxes[i]->win, line, 1, ' ', boxes[i]->width - 2);
+      boxes[i]->rows[line].flags = 0;
+    }
+    boxes[i]->num_used_lines = boxes[i]->line;
+
     const uint8_t TITLE_LEN = strlen(boxes[i]->title);
     uint16_t rel_pos =
         boxes[i]->width >= TITLE_LEN + 2
@@ -120,6 +187,9 @@ void draw_boxes() {
               (uint32_t)min(boxes[i]->width - 4 /* 2 spaces + 2 corner */,
                             TITLE_LEN + 2),
               boxes[i]->title);
+    // popups may have covered the box, ncurses only sends the characters
+    // that differ from the screen to the terminal anyway
+    touchwin(boxes[i]->win);
     wrefresh(boxes[i]->win);
   }
 }
@@ -131,6 +201,13 @@ void write_text_into_box(Box *box, const char *text) {
       break; // Stop if we exceed the box height
     }
     if (text[i] == '\n' || box->col >= (box->width - 1)) {
+      // the box isn't erased between frames, so the rest of the line could
+      // still show an older and longer text
+      if (text[i] == '\n' && box->col < box->width - 1 &&
+          !extended_features) {
+        mvwhline(box->win, box->line, box->col, ' ',
+                 box->width - 1 - box->col);
+      }
       box->line++;
       box->col = 1;
       if (text[i] == '\n') {
@@ -139,12 +216,50 @@ void write_text_into_box(Box *box, const char *text) {
     }
     if (box->line <
         (box->height - 1)) { // Ensure we don't write on the bottom border
+      box->rows[box->line].flags = 0;
       mvwaddch(box->win, box->line, box->col, text[i]);
       box->col++;
     }
   }
 }
 
+// only erases the box if its size changed, all other rows are overwritten or
+// kept as they are
+void prepare_box(Box *box) {
+  if (box->needs_erase || extended_features) {
+    werase(box->win);
+    memset(box->rows, 0, (UINT8_MAX + 1) * sizeof(Row_Key));
+    box->num_used_lines = 0;
+    box->needs_erase = false;
+  }
+  reset_box_line(box);
+  box->col = 1;
+  if (extended_features) {
+    make_unneccessary_spaces_visible(box);
+  }
+}
+
+bool skip_unchanged_row(Box *box, const Row_Key *key) {
+  const Row_Key *cached = &box->rows[box->line];
+  if (cached->flags != (key->flags | ROW_VALID) || cached->idx != key->idx ||
+      cached->content != key->content ||
+      cached->regs_mask != key->regs_mask) {
+    return false;
+  }
+  box->line += cached->num_lines;
+  box->col = 1;
+  return true;
+}
+
+void remember_row(Box *box, const Row_Key *key, uint8_t first_line) {
+  if (first_line >= box->height - 1) {
+    return;
+  }
+  box->rows[first_line] = *key;
+  box->rows[first_line].flags |= ROW_VALID;
+  box->rows[first_line].num_lines = box->line - first_line;
+}
+
 void reset_box_line(Box *box) { box->line = 1; }
 
 void make_unneccessary_spaces_visible(Box *box) {
@@ -1,7 +1,10 @@
 #include "../include/uart.h"
 #include "../include/parse_args.h"
+#include "../include/record.h"
 #include "../include/reti.h"
 #include "../include/special_opts.h"
+#include "../include/timing.h"
+#include "../include/undo.h"
 #include "../include/utils.h"
 #include <limits.h>
 #include <stdint.h>
@@ -30,6 +33,8 @@ bool receiving_finished = false;
 
 bool init_finished = false;
 
+uint64_t num_uart_outputs = 0;
+
 DataType datatype;
 
 char *all_send_data = NULL;
@@ -70,8 +75,98 @@ void reset_uart() {
   current_send_data = NULL;
 }
 
+void save_uart_state(Snapshot *snapshot) {
+  snapshot_put(snapshot, uart, NUM_UART_ADDRESSES);
+  snapshot_put(snapshot, &remaining_bytes, sizeof(remaining_bytes));
+  snapshot_put(snapshot, &num_bytes, sizeof(num_bytes));
+  snapshot_put(snapshot, &send_idx, sizeof(send_idx));
+  // while waiting the character at send_idx is already in the buffer
+  uint32_t send_data_len = 0;
+  if (send_data) {
+    send_data_len = datatype == INTEGER
+                        ? num_bytes
+                        : send_idx + (sending_finished && init_finished);
+  }
+  snapshot_put(snapshot, &send_data_len, sizeof(send_data_len));
+  snapshot_put(snapshot, send_data, send_data_len);
+
+  snapshot_put(snapshot, &received_num, sizeof(received_num));
+  snapshot_put(snapshot, &received_num_part, sizeof(received_num_part));
+  snapshot_put(snapshot, &received_num_idx, sizeof(received_num_idx));
+  snapshot_put(snapshot, &sending_waiting_time, sizeof(sending_waiting_time));
+  snapshot_put(snapshot, &receiving_waiting_time,
+               sizeof(receiving_waiting_time));
+  snapshot_put(snapshot, &sending_finished, sizeof(sending_finished));
+  snapshot_put(snapshot, &receiving_finished, sizeof(receiving_finished));
+  snapshot_put(snapshot, &init_finished, sizeof(init_finished));
+  snapshot_put(snapshot, &datatype, sizeof(datatype));
+
+  // the output shown in the debugger, -1 stands for NULL
+  char *strs[] = {all_send_data, current_send_data};
+  for (uint8_t i = 0; i < 2; i++) {
+    int32_t len = strs[i] ? (int32_t)strlen(strs[i]) : -1;
+    snapshot_put(snapshot, &len, sizeof(len));
+    snapshot_put(snapshot, strs[i], len > 0 ? len : 0);
+  }
+}
+
+bool restore_uart_state(Snapshot *snapshot) {
+  uint32_t send_data_len;
+  if (!snapshot_get(snapshot, uart, NUM_UART_ADDRESSES) ||
+      !snapshot_get(snapshot, &remaining_bytes, sizeof(remaining_bytes)) ||
+      !snapshot_get(snapshot, &num_bytes, sizeof(num_bytes)) ||
+      !snapshot_get(snapshot, &send_idx, sizeof(send_idx)) ||
+      !snapshot_get(snapshot, &send_data_len, sizeof(send_data_len))) {
+    return false;
+  }
+  free(send_data);
+  send_data = NULL;
+  if (send_data_len > 0) {
+    send_data = malloc(send_data_len);
+    if (!snapshot_get(snapshot, send_data, send_data_len)) {
+      return false;
+    }
+  }
+
+  if (!snapshot_get(snapshot, &received_num, sizeof(received_num)) ||
+      !snapshot_get(snapshot, &received_num_part, sizeof(received_num_part)) ||
+      !snapshot_get(snapshot, &received_num_idx, sizeof(received_num_idx)) ||
+      !snapshot_get(snapshot, &sending_waiting_time,
+                    sizeof(sending_waiting_time)) ||
+      !snapshot_get(snapshot, &receiving_waiting_time,
+                    sizeof(receiving_waiting_time)) ||
+      !snapshot_get(snapshot, &sending_finished, sizeof(sending_finished)) ||
+      !snapshot_get(snapshot, &receiving_finished,
+                    sizeof(receiving_finished)) ||
+      !snapshot_get(snapshot, &init_finished, sizeof(init_finished)) ||
+      !snapshot_get(snapshot, &datatype, sizeof(datatype))) {
+    return false;
+  }
+
+  char **strs[] = {&all_send_data, &current_send_data};
+  for (uint8_t i = 0; i < 2; i++) {
+    int32_t len;
+    if (!snapshot_get(snapshot, &len, sizeof(len))) {
+      return false;
+    }
+    free(*strs[i]);
+    *strs[i] = NULL;
+    if (len >= 0) {
+      *strs[i] = malloc(len + 1);
+      if (!snapshot_get(snapshot, *strs[i], len)) {
+        return false;
+      }
+      (*strs[i])[len] = '\0';
+    }
+  }
+  return true;
+}
+
 void uart_send() {
   if (!(read_array(uart, 2, true) & 0b00000001) && !sending_finished) {
+    if (undo_active) {
+      undo_uart_send();
+    }
     if (!init_finished) {
       datatype = uart[0];
       switch (datatype) {
@@ -92,7 +187,7 @@ void uart_send() {
     } else if (datatype == INTEGER) {
       send_data[num_bytes - remaining_bytes] = uart[0];
     } else if (datatype == STRING) {
-      send_data = realloc(send_data, 1);
+      send_data = realloc(send_data, send_idx + 1);
       send_data[send_idx] = uart[0];
       // TODO: ist send_idx nicht unnötig, weil es eh immer die letzte Stelle
       // ist?
@@ -104,12 +199,15 @@ void uart_send() {
     if (max_waiting_instrs == 0) {
       goto sending_finished;
     } else {
-      sending_waiting_time = rand() % max_waiting_instrs + 1;
+      sending_waiting_time = machine_rand() % max_waiting_instrs + 1;
     }
     sending_finished = true;
   } else if (sending_finished) {
-    sending_waiting_time--;
+    sending_waiting_time -= min(elapsed_ticks(), sending_waiting_time);
     if (sending_waiting_time == 0) {
+      if (undo_active) {
+        undo_uart_send();
+      }
     sending_finished:
       if (datatype == STRING) {
         if (!init_finished) {
@@ -130,6 +228,7 @@ void uart_send() {
           send_idx++;
           if (uart[0] == 0) {
             adjust_print(true, "%s\n", "%s ", send_data);
+            num_uart_outputs++;
             if (debug_mode) {
               uint8_t len_new_data = strlen((char *)send_data);
               if (all_send_data) {
@@ -167,6 +266,7 @@ void uart_send() {
           if (remaining_bytes == 0) {
             uint32_t num = swap_endian_32(*((uint32_t *)send_data));
             adjust_print(true, "%d\n", "%d ", num);
+            num_uart_outputs++;
             if (debug_mode) {
               uint8_t len_new_data = num_digits_for_num(num);
               if (all_send_data) {
@@ -200,7 +300,7 @@ void uart_receive() {
       if (read_metadata && input_idx < input_len) {
         received_num = uart_input[input_idx];
       } else {
-        received_num = get_user_input();
+        received_num = recorded_user_input();
       }
       received_num_idx = 3;
     }
@@ -216,11 +316,11 @@ void uart_receive() {
     if (max_waiting_instrs == 0) {
       goto receiving_finished;
     } else {
-      receiving_waiting_time = rand() % max_waiting_instrs + 1;
+      receiving_waiting_time = machine_rand() % max_waiting_instrs + 1;
     }
     receiving_finished = true;
   } else if (receiving_finished) {
-    receiving_waiting_time--;
+    receiving_waiting_time -= min(elapsed_ticks(), receiving_waiting_time);
     if (receiving_waiting_time == 0) {
     receiving_finished:
       uart[1] = received_num_part; // & 0xFF; not necessary
@@ -0,0 +1,248 @@
+#include "../include/undo.h"
+#include "../include/datastructures.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/record.h"
+#include "../include/reti.h"
+#include "../include/snapshot.h"
+#include "../include/timing.h"
+#include "../include/uart.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool undo_active = false;
+
+// ring buffer, the oldest instructions get dropped when it is full
+static Undo_Entry *undo_log = NULL;
+static uint32_t head = 0, tail = 0, num_entries = 0;
+static uint64_t num_instrs = 0;
+
+typedef struct {
+  void *ptr;
+  uint16_t size;
+} Tracked_Var;
+
+// everything besides the memory that an instruction, the UART or an
+// interrupt can change, compared before and after each instruction. The
+// counters go back too, so that they keep matching the shown state
+static Tracked_Var tracked_vars[] = {
+    {NULL, sizeof(uint32_t) * NUM_REGISTERS}, // regs, set in init_undo
+    {NULL, NUM_UART_ADDRESSES},               // uart, set in init_undo
+    {&remaining_bytes, sizeof(remaining_bytes)},
+    {&num_bytes, sizeof(num_bytes)},
+    {&send_idx, sizeof(send_idx)},
+    {&received_num, sizeof(received_num)},
+    {&received_num_part, sizeof(received_num_part)},
+    {&received_num_idx, sizeof(received_num_idx)},
+    {&sending_waiting_time, sizeof(sending_waiting_time)},
+    {&receiving_waiting_time, sizeof(receiving_waiting_time)},
+    {&sending_finished, sizeof(sending_finished)},
+    {&receiving_finished, sizeof(receiving_finished)},
+    {&init_finished, sizeof(init_finished)},
+    {&datatype, sizeof(datatype)},
+    {&input_idx, sizeof(input_idx)},
+    {&timer_cnt, sizeof(timer_cnt)},
+    {&prng_state, sizeof(prng_state)},
+    {&interrupt_timer_active, sizeof(interrupt_timer_active)},
+    {&keypress_interrupt_active, sizeof(keypress_interrupt_active)},
+    {isr_priority_stack, MAX_STACK_SIZE},
+    {&stack_top, sizeof(stack_top)},
+    {isr_heap, HEAP_SIZE},
+    {&heap_size, sizeof(heap_size)},
+    {&current_isr, sizeof(current_isr)},
+    {&isr_active, sizeof(isr_active)},
+    {&isr_finished, sizeof(isr_finished)},
+    {&step_into_activated, sizeof(step_into_activated)},
+    {&restore_isr_active, sizeof(restore_isr_active)},
+    {&restore_step_into_activated, sizeof(restore_step_into_activated)},
+    {&restore_isr_finished, sizeof(restore_isr_finished)},
+    {&num_executed_instrs, sizeof(num_executed_instrs)},
+    {&num_isr_returns, sizeof(num_isr_returns)},
+    {&num_uart_outputs, sizeof(num_uart_outputs)},
+    {&cycles, sizeof(cycles)},
+};
+#define NUM_TRACKED_VARS (sizeof(tracked_vars) / sizeof(tracked_vars[0]))
+
+static uint8_t *shadow = NULL;
+static uint32_t shadow_size = 0;
+
+void init_undo() {
+  undo_log = malloc(sizeof(Undo_Entry) * UNDO_LOG_SIZE);
+  tracked_vars[0].ptr = regs;
+  tracked_vars[1].ptr = uart;
+  for (uint8_t i = 0; i < NUM_TRACKED_VARS; i++) {
+    shadow_size += tracked_vars[i].size;
+  }
+  shadow = malloc(shadow_size);
+  if (!undo_log || !shadow) {
+    fprintf(stderr, "Error: Failed to allocate the undo log\n");
+    exit(EXIT_FAILURE);
+  }
+  undo_active = true;
+}
+
+static Snapshot *uart_state_of_entry(Undo_Entry *entry) {
+  Snapshot *uart_state;
+  memcpy(&uart_state, entry->old, sizeof(uart_state));
+  return uart_state;
+}
+
+static void free_entry(Undo_Entry *entry) {
+  if (entry->type == UNDO_UART) {
+    Snapshot *uart_state = uart_state_of_entry(entry);
+    free_snapshot(uart_state);
+    free(uart_state);
+  }
+}
+
+static void drop_oldest_instr() {
+  while (num_entries > 0) {
+    uint8_t type = undo_log[tail].type;
+    free_entry(&undo_log[tail]);
+    tail = (tail + 1) % UNDO_LOG_SIZE;
+    num_entries--;
+    if (type == UNDO_INSTR_END) {
+      num_instrs--;
+      return;
+    }
+  }
+}
+
+void clear_undo_log() {
+  for (uint32_t i = 0; i < num_entries; i++) {
+    free_entry(&undo_log[(tail + i) % UNDO_LOG_SIZE]);
+  }
+  head = tail = num_entries = 0;
+  num_instrs = 0;
+}
+
+static void push_entry(Undo_Entry *entry) {
+  if (num_entries == UNDO_LOG_SIZE) {
+    drop_oldest_instr();
+  }
+  undo_log[head] = *entry;
+  head = (head + 1) % UNDO_LOG_SIZE;
+  num_entries++;
+}
+
+void undo_instr_begin() {
+  uint8_t *pos = shadow;
+  for (uint8_t i = 0; i < NUM_TRACKED_VARS; i++) {
+    memcpy(pos, tracked_vars[i].ptr, tracked_vars[i].size);
+    pos += tracked_vars[i].size;
+  }
+}
+
+// the registers of the UART are a tracked variable, reading them here would
+// also warn about reading the send register
+void undo_mem_write(uint32_t addr) {
+  if (addr >> 30 == UART_CONST) {
+    return;
+  }
+  Undo_Entry entry = {.type = UNDO_MEM, .addr = addr, .len = 4};
+  uint32_t old_value = read_storage_raw(addr);
+  memcpy(entry.old, &old_value, sizeof(old_value));
+  push_entry(&entry);
+}
+
+// sending reallocates the buffers of the UART, so they are saved as a whole,
+// which only happens a few times per sent character
+void undo_uart_send() {
+  Snapshot *uart_state = calloc(1, sizeof(Snapshot));
+  save_uart_state(uart_state);
+  Undo_Entry entry = {.type = UNDO_UART};
+  memcpy(entry.old, &uart_state, sizeof(uart_state));
+  push_entry(&entry);
+}
+
+static void push_changed_var(uint8_t var, uint8_t *old) {
+  uint8_t *new = tracked_vars[var].ptr;
+  for (uint16_t offset = 0; offset < tracked_vars[var].size;
+       offset += UNDO_CHUNK_SIZE) {
+    uint8_t len = tracked_vars[var].size - offset < UNDO_CHUNK_SIZE
+                      ? tracked_vars[var].size - offset
+                      : UNDO_CHUNK_SIZE;
+    if (memcmp(old + offset, new + offset, len) != 0) {
+      Undo_Entry entry = {
+          .type = UNDO_VAR, .var = var, .len = len, .addr = offset};
+      memcpy(entry.old, old + offset, len);
+      push_entry(&entry);
+    }
+  }
+}
+
+void undo_instr_end() {
+  uint8_t *pos = shadow;
+  for (uint8_t i = 0; i < NUM_TRACKED_VARS; i++) {
+    if (memcmp(pos, tracked_vars[i].ptr, tracked_vars[i].size) != 0) {
+      push_changed_var(i, pos);
+    }
+    pos += tracked_vars[i].size;
+  }
+  Undo_Entry entry = {.type = UNDO_INSTR_END};
+  push_entry(&entry);
+  num_instrs++;
+}
+
+static void undo_entry(Undo_Entry *entry) {
+  switch (entry->type) {
+  case UNDO_MEM: {
+    uint32_t old_value;
+    memcpy(&old_value, entry->old, sizeof(old_value));
+    if (entry->addr >> 30 == EPROM_CONST) {
+      eprom[entry->addr] = old_value;
+    } else {
+      write_file(sram, entry->addr & 0x7FFFFFFF, old_value);
+    }
+    break;
+  }
+  case UNDO_VAR:
+    memcpy((uint8_t *)tracked_vars[entry->var].ptr + entry->addr, entry->old,
+           entry->len);
+    break;
+  case UNDO_UART: {
+    Snapshot *uart_state = uart_state_of_entry(entry);
+    restore_uart_state(uart_state);
+    free_snapshot(uart_state);
+    free(uart_state);
+    break;
+  }
+  }
+}
+
+// returns false if there is nothing left to undo
+bool step_back() {
+  if (num_instrs == 0) {
+    return false;
+  }
+  // the entry at the top is the end of the last instruction
+  head = (head + UNDO_LOG_SIZE - 1) % UNDO_LOG_SIZE;
+  num_entries--;
+  uint32_t end = head;
+  while (num_entries > 0) {
+    uint32_t prev = (head + UNDO_LOG_SIZE - 1) % UNDO_LOG_SIZE;
+    if (undo_log[prev].type == UNDO_INSTR_END) {
+      break;
+    }
+    head = prev;
+    num_entries--;
+    if (undo_log[head].type != UNDO_VAR) {
+      undo_entry(&undo_log[head]);
+    }
+  }
+  // the variables hold the values from the beginning of the instruction, so
+  // they have to win over the state of the UART saved in the middle of it
+  for (uint32_t i = head; i != end; i = (i + 1) % UNDO_LOG_SIZE) {
+    if (undo_log[i].type == UNDO_VAR) {
+      undo_entry(&undo_log[i]);
+    }
+  }
+  num_instrs--;
+  return true;
+}
+
+uint64_t num_undoable_instrs() { return num_instrs; }
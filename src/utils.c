@@ -1,4 +1,5 @@
 #include "../include/utils.h"
+#include "../include/arena.h"
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -194,7 +195,7 @@ char *create_heading(char insert_chr, const char *text, int linewidth) {
   if (total_length > linewidth) {
     // If the total length exceeds linewidth, truncate the text
     int max_text_len = linewidth - 4;
-    char *truncated_text = (char *)malloc((max_text_len + 1) * sizeof(char));
+    char *truncated_text = frame_alloc(max_text_len + 1);
     strncpy(truncated_text, text, max_text_len);
     truncated_text[max_text_len] = '\0';
     text = truncated_text;
@@ -206,8 +207,8 @@ char *create_heading(char insert_chr, const char *text, int linewidth) {
   int left_insert_chr = remaining_length / 2;
   int right_insert_chr = remaining_length - left_insert_chr;
 
-  // Allocate memory for the result string
-  char *result = (char *)malloc(linewidth + 1);
+  // Allocate memory for the result string, it only lives until the next frame
+  char *result = frame_alloc(linewidth + 1);
 
   // Construct the result string
   int pos = 0;
@@ -226,9 +227,7 @@ char *create_heading(char insert_chr, const char *text, int linewidth) {
   return result;
 }
 
-char *int_to_bin_str(int num, int bits) {
-  char *bin_str = (char *)malloc(bits + 1);
-
+char *write_bin_str(char *bin_str, int num, int bits) {
   bin_str[bits] = '\0';
 
   for (int i = bits - 1; i >= 0; i--) {
@@ -239,6 +238,10 @@ char *int_to_bin_str(int num, int bits) {
   return bin_str;
 }
 
+char *int_to_bin_str(int num, int bits) {
+  return write_bin_str(malloc(bits + 1), num, bits);
+}
+
 uint8_t num_digits_for_num(uint64_t num) {
   if (num == 0) {
     return 1;
@@ -251,10 +254,8 @@ uint8_t num_digits_for_num(uint64_t num) {
   }
 }
 
-char *num_digits_for_idx_str(uint64_t max_idx) {
-  char *buffer = malloc(20);
-  sprintf(buffer, "%d", (uint8_t)ceil(log10(max_idx)));
-  return buffer;
+uint8_t num_digits_for_idx(uint64_t max_idx) {
+  return (uint8_t)ceil(log10(max_idx));
 }
 
 
@@ -265,8 +266,8 @@ char *create_formatted_str(const char *format, va_list args) {
     int size = vsnprintf(NULL, 0, format, args_copy);
     va_end(args_copy);
 
-    // Create the formatted string
-    char *result = (char *)malloc(size + 1);
+    // Create the formatted string, it only lives until the next frame
+    char *result = frame_alloc(size + 1);
     vsnprintf(result, size + 1, format, args);
 
     return result;
@@ -0,0 +1,188 @@
+#include "../include/watchpoints.h"
+#include "../include/dap.h"
+#include "../include/debug.h"
+#include "../include/input_output.h"
+#include "../include/interpr.h"
+#include "../include/parse_args.h"
+#include "../include/protocol.h"
+#include "../include/reti.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint8_t num_watchpoints = 0;
+bool watchpoint_hit = false;
+char watchpoint_hit_msg[MAX_LEN_WATCHPOINT_HIT];
+
+static Watchpoint watchpoints[MAX_WATCHPOINTS];
+
+// one bit per SRAM page that contains at least one watched cell, so that the
+// accesses to all other pages only cost a single bit test
+static uint8_t *watched_pages = NULL;
+static uint32_t num_pages;
+
+static const char *kind_to_name[] = {"read", "write", "change"};
+
+void init_watchpoints() {
+  num_pages = ((uint64_t)sram_size + page_size - 1) / page_size;
+  watched_pages = calloc((num_pages + 7) / 8, sizeof(uint8_t));
+  if (!watched_pages) {
+    fprintf(stderr, "Error: Failed to allocate the watchpoints\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static bool parse_sram_addr(const char *str, char **endptr, uint32_t *idx) {
+  uint64_t addr = strtoull(str, endptr, 10);
+  if (*endptr == str || str[0] == '-' || addr > UINT32_MAX ||
+      !(addr >> 31) || (addr & 0x7FFFFFFF) >= sram_size) {
+    return false;
+  }
+  *idx = addr & 0x7FFFFFFF;
+  return true;
+}
+
+// the kinds r, w and c followed by an address or a range from-to of
+// addresses like the ones in the registers, e.g. "wc 2147549180-2147549183"
+bool parse_watchpoint(const char *str, Watchpoint *watchpoint) {
+  watchpoint->kinds = 0;
+  for (; *str != ' ' && *str != '\0'; str++) {
+    switch (*str) {
+    case 'r':
+      watchpoint->kinds |= WATCH_READ;
+      break;
+    case 'w':
+      watchpoint->kinds |= WATCH_WRITE;
+      break;
+    case 'c':
+      watchpoint->kinds |= WATCH_CHANGE;
+      break;
+    default:
+      return false;
+    }
+  }
+  while (*str == ' ') {
+    str++;
+  }
+  char *endptr;
+  if (watchpoint->kinds == 0 ||
+      !parse_sram_addr(str, &endptr, &watchpoint->from)) {
+    return false;
+  }
+  watchpoint->to = watchpoint->from;
+  if (*endptr == '-' &&
+      !parse_sram_addr(endptr + 1, &endptr, &watchpoint->to)) {
+    return false;
+  }
+  return *endptr == '\0' && watchpoint->from <= watchpoint->to;
+}
+
+static void update_watched_pages() {
+  memset(watched_pages, 0, (num_pages + 7) / 8);
+  for (uint8_t i = 0; i < num_watchpoints; i++) {
+    for (uint32_t page = watchpoints[i].from / page_size;
+         page <= watchpoints[i].to / page_size; page++) {
+      watched_pages[page / 8] |= 1 << (page % 8);
+    }
+  }
+}
+
+// removes the watchpoint if the same one already exists, returns false if
+// there is no space left for another one
+bool toggle_watchpoint(Watchpoint *watchpoint) {
+  for (uint8_t i = 0; i < num_watchpoints; i++) {
+    if (watchpoints[i].from == watchpoint->from &&
+        watchpoints[i].to == watchpoint->to &&
+        watchpoints[i].kinds == watchpoint->kinds) {
+      watchpoints[i] = watchpoints[--num_watchpoints];
+      update_watched_pages();
+      return true;
+    }
+  }
+  if (num_watchpoints == MAX_WATCHPOINTS) {
+    return false;
+  }
+  watchpoints[num_watchpoints++] = *watchpoint;
+  update_watched_pages();
+  return true;
+}
+
+bool is_watched(uint32_t addr) {
+  if (num_watchpoints == 0 || !(addr >> 31)) {
+    return false;
+  }
+  uint32_t idx = addr & 0x7FFFFFFF;
+  for (uint8_t i = 0; i < num_watchpoints; i++) {
+    if (watchpoints[i].from <= idx && idx <= watchpoints[i].to) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void report_hit(Watch_Kind kind, uint32_t idx, uint32_t old_value,
+                       uint32_t value) {
+  if (watchpoint_hit) {
+    // only the first access of an instruction is reported
+    return;
+  }
+  watchpoint_hit = true;
+  breakpoint_encountered = true;
+  Instruction *instr = machine_to_assembly(read_storage_raw(instr_pc));
+  char *instr_str = assembly_to_str(instr);
+  uint8_t kind_idx = kind == WATCH_READ ? 0 : kind == WATCH_WRITE ? 1 : 2;
+  if (kind == WATCH_READ) {
+    snprintf(watchpoint_hit_msg, MAX_LEN_WATCHPOINT_HIT,
+             "%s of SRAM %u by %u: %s", kind_to_name[kind_idx], idx, instr_pc,
+             instr_str);
+  } else {
+    snprintf(watchpoint_hit_msg, MAX_LEN_WATCHPOINT_HIT,
+             "%s of SRAM %u from %d to %d by %u: %s", kind_to_name[kind_idx],
+             idx, old_value, value, instr_pc, instr_str);
+  }
+  free(instr_str);
+  free(instr);
+}
+
+void check_watchpoints(uint32_t addr, bool is_write, uint32_t value) {
+  if (!(addr >> 31)) {
+    return;
+  }
+  uint32_t idx = addr & 0x7FFFFFFF;
+  uint32_t page = idx / page_size;
+  if (page >= num_pages || !(watched_pages[page / 8] & (1 << (page % 8)))) {
+    return;
+  }
+  for (uint8_t i = 0; i < num_watchpoints; i++) {
+    Watchpoint *watchpoint = &watchpoints[i];
+    if (idx < watchpoint->from || watchpoint->to < idx) {
+      continue;
+    }
+    if (!is_write) {
+      if (watchpoint->kinds & WATCH_READ) {
+        report_hit(WATCH_READ, idx, 0, 0);
+      }
+      continue;
+    }
+    uint32_t old_value = read_storage_raw(addr);
+    if (watchpoint->kinds & WATCH_WRITE) {
+      report_hit(WATCH_WRITE, idx, old_value, value);
+    } else if ((watchpoint->kinds & WATCH_CHANGE) && old_value != value) {
+      report_hit(WATCH_CHANGE, idx, old_value, value);
+    }
+  }
+}
+
+void show_watchpoint_hit() {
+  if (protocol_active) {
+    send_protocol_message("watchpoint", watchpoint_hit_msg);
+  } else if (dap_active) {
+    dap_watchpoint_hit(watchpoint_hit_msg);
+  } else if (legacy_debug_tui) {
+    printf("Watchpoint: %s\n", watchpoint_hit_msg);
+  } else {
+    display_notification_box("Watchpoint", watchpoint_hit_msg);
+  }
+  watchpoint_hit = false;
+}
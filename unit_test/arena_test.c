@@ -0,0 +1,34 @@
+#include "../include/arena.h"
+#include <assert.h>
+#include <string.h>
+
+void test_frame_alloc_reuses_memory_after_reset() {
+  char *first = frame_alloc(10);
+  strcpy(first, "123456789");
+  char *second = frame_str_copy("abc");
+  assert(second != first);
+  assert(strcmp(first, "123456789") == 0);
+
+  reset_frame_arena();
+  assert(frame_alloc(10) == first);
+}
+
+void test_frame_alloc_larger_than_chunk() {
+  reset_frame_arena();
+  char *small = frame_alloc(FRAME_ARENA_CHUNK_SIZE - 8);
+  char *large = frame_alloc(2 * FRAME_ARENA_CHUNK_SIZE);
+  assert(large != small);
+
+  // the chunks from the last frame are reused and not allocated again
+  reset_frame_arena();
+  assert(frame_alloc(FRAME_ARENA_CHUNK_SIZE - 8) == small);
+  assert(frame_alloc(2 * FRAME_ARENA_CHUNK_SIZE) == large);
+  fin_frame_arena();
+}
+
+int main() {
+  test_frame_alloc_reuses_memory_after_reset();
+  test_frame_alloc_larger_than_chunk();
+
+  return 0;
+}
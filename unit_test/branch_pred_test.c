@@ -0,0 +1,69 @@
+#include "../include/branch_pred.h"
+#include <assert.h>
+
+void test_parse_branch_pred_config() {
+  assert(parse_branch_pred_config("static"));
+  assert(predictor == PRED_STATIC);
+  assert(parse_branch_pred_config("gshare:12"));
+  assert(predictor == PRED_GSHARE && predictor_bits == 12);
+  assert(parse_branch_pred_config("1bit"));
+  assert(predictor == PRED_1BIT && predictor_bits == DEFAULT_PREDICTOR_BITS);
+  assert(!parse_branch_pred_config("3bit"));
+  assert(!parse_branch_pred_config("static:4"));
+  assert(!parse_branch_pred_config("2bit:0"));
+  assert(!parse_branch_pred_config("2bit:25"));
+  assert(!parse_branch_pred_config("2bi"));
+}
+
+void test_static_predictor() {
+  assert(parse_branch_pred_config("static"));
+  init_branch_pred();
+  assert(record_branch(10, -5, true));
+  assert(record_branch(10, 3, false));
+  assert(!record_branch(10, 3, true));
+  assert(num_branches == 3 && num_mispredictions == 1);
+}
+
+void test_1bit_predictor() {
+  assert(parse_branch_pred_config("1bit:4"));
+  init_branch_pred();
+  assert(!record_branch(20, -3, true));
+  assert(record_branch(20, -3, true));
+  assert(!record_branch(20, -3, false));
+  assert(!record_branch(20, -3, true));
+}
+
+void test_2bit_predictor() {
+  assert(parse_branch_pred_config("2bit:4"));
+  init_branch_pred();
+  // starts weakly not taken
+  assert(!record_branch(30, -3, true));
+  assert(record_branch(30, -3, true));
+  assert(record_branch(30, -3, true));
+  // one exit of the loop doesn't change the prediction of the next run
+  assert(!record_branch(30, -3, false));
+  assert(record_branch(30, -3, true));
+}
+
+void test_gshare_predictor() {
+  assert(parse_branch_pred_config("gshare:8"));
+  init_branch_pred();
+  // alternating pattern that a 2 bit counter per PC can't learn
+  for (uint32_t i = 0; i < 20; i++) {
+    record_branch(40, 2, i % 2);
+  }
+  uint64_t mispredictions_before = num_mispredictions;
+  for (uint32_t i = 20; i < 40; i++) {
+    record_branch(40, 2, i % 2);
+  }
+  assert(num_mispredictions == mispredictions_before);
+}
+
+int main() {
+  test_parse_branch_pred_config();
+  test_static_predictor();
+  test_1bit_predictor();
+  test_2bit_predictor();
+  test_gshare_predictor();
+  return 0;
+}
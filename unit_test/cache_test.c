@@ -0,0 +1,92 @@
+#include "../include/assemble.h"
+#include "../include/cache.h"
+#include "../include/interpr.h"
+#include "../include/reti.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SRAM_ADDR(idx) (0x80000000 | (idx))
+
+void setup_cache(const char *spec) {
+  assert(parse_cache_config(spec));
+  init_cache();
+}
+
+void test_parse_cache_config() {
+  assert(parse_cache_config("64:2:4"));
+  assert(cache_config.size == 64 && cache_config.assoc == 2 &&
+         cache_config.line_size == 4);
+  assert(cache_config.replacement == CACHE_LRU);
+  assert(cache_config.write_policy == CACHE_WRITE_BACK);
+  assert(parse_cache_config("64:4:4:fifo:wt"));
+  assert(cache_config.replacement == CACHE_FIFO);
+  assert(cache_config.write_policy == CACHE_WRITE_THROUGH);
+  assert(!parse_cache_config("63:2:4"));
+  assert(!parse_cache_config("64:2"));
+  assert(!parse_cache_config("8:4:4"));
+  assert(!parse_cache_config("64:2:4:mru"));
+  assert(!parse_cache_config("64:2:4:lru:wx"));
+}
+
+void test_cache_hits_and_misses() {
+  // direct mapped, 4 sets with 4 words per line
+  setup_cache("16:1:4");
+  assert(!cache_access(SRAM_ADDR(1000), false));
+  assert(cache_access(SRAM_ADDR(1003), false));
+  assert(!cache_access(SRAM_ADDR(1004), false));
+  // same set as 1000, so it gets evicted
+  assert(!cache_access(SRAM_ADDR(1016), false));
+  assert(!cache_access(SRAM_ADDR(1000), false));
+  // the UART is never cached
+  assert(!cache_access(0x40000000, false));
+  assert(!cache_access(0x40000000, false));
+  assert(cache_region_counts[SRAM_D][CACHE_HITS] == 1);
+  assert(cache_region_counts[SRAM_D][CACHE_MISSES] == 4);
+  assert(cache_region_counts[UART][CACHE_MISSES] == 0);
+}
+
+void test_cache_lru_and_writeback() {
+  // one set with two ways
+  setup_cache("8:2:4:lru:wb");
+  cache_access(SRAM_ADDR(0), true);
+  cache_access(SRAM_ADDR(4), false);
+  assert(cache_access(SRAM_ADDR(0), false));
+  // evicts line 4, which was used least recently and is clean
+  cache_access(SRAM_ADDR(8), false);
+  assert(cache_region_counts[SRAM_D][CACHE_WRITEBACKS] == 0);
+  assert(cache_access(SRAM_ADDR(0), false));
+  // evicts the dirty line 0
+  cache_access(SRAM_ADDR(12), false);
+  cache_access(SRAM_ADDR(4), false);
+  assert(cache_region_counts[SRAM_D][CACHE_WRITEBACKS] == 1);
+}
+
+void test_cache_fifo_and_write_through() {
+  setup_cache("8:2:4:fifo:wt");
+  cache_access(SRAM_ADDR(0), false);
+  cache_access(SRAM_ADDR(4), false);
+  assert(cache_access(SRAM_ADDR(0), true));
+  // evicts line 0 although it was used last, because it came in first
+  cache_access(SRAM_ADDR(8), false);
+  assert(!cache_access(SRAM_ADDR(0), false));
+  // no allocation on a write miss
+  assert(!cache_access(SRAM_ADDR(100), true));
+  assert(!cache_access(SRAM_ADDR(100), false));
+  assert(cache_region_counts[SRAM_D][CACHE_WRITE_THROUGHS] == 2);
+  assert(cache_region_counts[SRAM_D][CACHE_WRITEBACKS] == 0);
+}
+
+int main() {
+  regs = malloc(sizeof(uint32_t) * NUM_REGISTERS);
+  memset(regs, 0, sizeof(uint32_t) * NUM_REGISTERS);
+  // everything below the stack pointer belongs to the datasegment
+  regs[SP] = SRAM_ADDR(100000);
+  instr_pc = 0;
+  test_parse_cache_config();
+  test_cache_hits_and_misses();
+  test_cache_lru_and_writeback();
+  test_cache_fifo_and_write_through();
+  free(regs);
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include "../include/assemble.h"
+#include "../include/condition.h"
+#include "../include/reti.h"
+#include "../include/uart.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool check(const char *str) {
+  Condition condition;
+  assert(compile_condition(str, &condition));
+  return eval_condition(&condition);
+}
+
+void test_registers_and_constants() {
+  regs[ACC] = -3;
+  regs[IN1] = 7;
+  assert(check("ACC < 0"));
+  assert(!check("ACC >= 0"));
+  assert(check("IN1 == 7 && ACC != 7"));
+  assert(check("in1 + ACC * 2 == 1"));
+  assert(check("-ACC == 3"));
+  assert(check("!(IN1 > 10) || 0"));
+  assert(check("4294967295 == -1"));
+}
+
+void test_memory() {
+  regs[DS] = 2;
+  eprom[7] = 42;
+  assert(check("M[DS+5] == 42"));
+  assert(check("ACC < 0 && M[DS + 5] == 42"));
+  assert(!check("M[M[DS+5] - 35] == 0 || M[7] != 42"));
+}
+
+// reading the UART in a condition mustn't warn like a LOAD of the program
+void test_uart() {
+  uart[0] = 5;
+  uart[2] = 0b11;
+  FILE *original_stderr = stderr;
+  stderr = tmpfile();
+  assert(check("M[1073741824] == 5"));
+  assert(check("M[1073741826] == 3"));
+  assert(check("M[1073741827] == 0"));
+  assert(ftell(stderr) == 0);
+  fclose(stderr);
+  stderr = original_stderr;
+}
+
+// addresses outside of the memories mustn't be read, e.g. from the debug
+// console of an editor
+void test_out_of_range() {
+  regs[DS] = 2;
+  assert(check("M[16] == 0"));
+  assert(check("M[5000] == 0 && M[30000] == 0"));
+  assert(check("M[1073741824 + 5000] == 0"));
+  write_file(sram, 3, 9);
+  assert(check("M[2147483651] == 9"));
+  assert(check("M[2147483652] == 0"));
+  assert(check("M[2147483748] == 0"));
+  assert(check("M[4294967295] == 0"));
+}
+
+void test_precedence() {
+  assert(check("1 + 2 * 3 == 7"));
+  assert(check("(1 + 2) * 3 == 9"));
+  assert(check("1 || 0 && 0"));
+  assert(check("2 - 1 - 1 == 0"));
+}
+
+void test_invalid_conditions() {
+  Condition condition;
+  assert(!compile_condition("", &condition));
+  assert(!compile_condition("ACC <", &condition));
+  assert(!compile_condition("ACCU == 1", &condition));
+  assert(!compile_condition("M[DS", &condition));
+  assert(!compile_condition("(1 == 1", &condition));
+  assert(!compile_condition("1 == 1 1", &condition));
+  assert(!compile_condition("4294967296", &condition));
+}
+
+int main() {
+  regs = calloc(NUM_REGISTERS, sizeof(uint32_t));
+  eprom = calloc(16, sizeof(uint32_t));
+  uart = calloc(NUM_UART_ADDRESSES, sizeof(uint8_t));
+  num_instrs_start_prgrm = 16;
+  sram = tmpfile();
+  test_registers_and_constants();
+  test_memory();
+  test_uart();
+  test_out_of_range();
+  test_precedence();
+  test_invalid_conditions();
+  return 0;
+}
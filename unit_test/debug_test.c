@@ -1,5 +1,6 @@
 #include "../include/assemble.h"
 #include "../include/debug.h"
+#include "../include/disasm_cache.h"
 #include "../include/utils.h"
 #include <assert.h>
 #include <stdint.h>
@@ -53,11 +54,24 @@ void test_mem_content_to_str_negative() {
   assert(strcmp(instr_str, "-42") == 0);
 }
 
+void test_cached_assembly_str() {
+  uint32_t storein = 0b10010111110111111111111111111111;
+  const char *instr_str = cached_assembly_str(42, storein);
+  assert(strcmp(instr_str, assembly_to_str(machine_to_assembly(storein))) == 0);
+  uint32_t machine_instr;
+  assert(cached_machine_instr(42, &machine_instr));
+  assert(!cached_machine_instr(43, &machine_instr));
+
+  invalidate_disasm(42);
+  assert(!cached_machine_instr(42, &machine_instr));
+}
+
 int main() {
   test_assembly_to_str();
   test_assembly_to_str_negative();
   test_mem_content_to_str();
   test_mem_content_to_str_negative();
+  test_cached_assembly_str();
   test_read_stdin();
 
   return 0;
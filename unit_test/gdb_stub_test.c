@@ -0,0 +1,148 @@
+#include "../include/breakpoints.h"
+#include "../include/debug.h"
+#include "../include/gdb_stub.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TEST_SOCKET_PATH "/tmp/reti_gdb_stub_test.sock"
+
+static void send_str(int fd, const char *str) {
+  assert(send(fd, str, strlen(str), MSG_NOSIGNAL) == (ssize_t)strlen(str));
+}
+
+static char recv_char(int fd) {
+  char ch;
+  assert(recv(fd, &ch, 1, 0) == 1);
+  return ch;
+}
+
+static void send_packet(int fd, const char *data) {
+  uint8_t checksum = 0;
+  for (const char *ch = data; *ch != '\0'; ch++) {
+    checksum += *ch;
+  }
+  char packet[GDB_PACKET_SIZE + 5];
+  sprintf(packet, "$%s#%02x", data, checksum);
+  send_str(fd, packet);
+  assert(recv_char(fd) == '+');
+}
+
+static void recv_packet(int fd, char *data) {
+  assert(recv_char(fd) == '$');
+  uint8_t checksum = 0;
+  size_t len = 0;
+  char ch;
+  while ((ch = recv_char(fd)) != '#') {
+    data[len++] = ch;
+    checksum += ch;
+  }
+  data[len] = '\0';
+  char checksum_str[3] = {recv_char(fd), recv_char(fd), '\0'};
+  assert(strtoul(checksum_str, NULL, 16) == checksum);
+  send_str(fd, "+");
+}
+
+static void expect_reply(int fd, const char *data, const char *reply) {
+  char received[GDB_PACKET_SIZE];
+  send_packet(fd, data);
+  recv_packet(fd, received);
+  assert(strcmp(received, reply) == 0);
+}
+
+// the stub runs in a child, the test is GDB
+static void run_stub() {
+  init_gdb_stub();
+  evaluate_gdb_requests();
+  // c
+  assert(!breakpoint_encountered);
+  assert(is_breakpoint(2));
+  assert(regs[ACC] == 7);
+  breakpoint_encountered = true;
+  evaluate_gdb_requests();
+  // s
+  assert(breakpoint_encountered);
+  assert(regs[PC] == 4);
+  evaluate_gdb_requests();
+  // D
+  assert(!breakpoint_encountered);
+  exit(EXIT_SUCCESS);
+}
+
+static int connect_to_stub() {
+  struct sockaddr_un addr = {0};
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, TEST_SOCKET_PATH);
+  for (uint16_t i = 0; i < 500; i++) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+      return fd;
+    }
+    close(fd);
+    usleep(10000);
+  }
+  assert(false);
+  return -1;
+}
+
+void test_gdb_session() {
+  parse_args(4, (char *[]){"", "-f", "/tmp", "-"});
+  init_reti();
+  load_adjusted_eprom_prgrm();
+  init_breakpoints();
+  regs[ACC] = 42;
+  gdb_address = TEST_SOCKET_PATH;
+  unlink(TEST_SOCKET_PATH);
+
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    run_stub();
+  }
+  int fd = connect_to_stub();
+
+  // a packet with a wrong checksum is sent again
+  send_str(fd, "$?#00");
+  assert(recv_char(fd) == '-');
+  expect_reply(fd, "?", "S05");
+
+  char reply[GDB_PACKET_SIZE];
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++) {
+    sprintf(reply + 8 * i, "%08x", regs[i]);
+  }
+  expect_reply(fd, "g", reply);
+
+  sprintf(reply, "%08x%08x", eprom[0], eprom[1]);
+  expect_reply(fd, "m0,8", reply);
+  sprintf(reply, "%04x%02x", eprom[0] & 0xFFFF, eprom[1] >> 24);
+  expect_reply(fd, "m2,3", reply);
+
+  expect_reply(fd, "Z0,8,4", "OK");
+  expect_reply(fd, "Z0,6,4", "E01");
+  expect_reply(fd, "P3=00000007", "OK");
+  send_packet(fd, "c");
+  recv_packet(fd, reply);
+  assert(strcmp(reply, "S05") == 0);
+  send_packet(fd, "s10");
+  recv_packet(fd, reply);
+  assert(strcmp(reply, "S05") == 0);
+  expect_reply(fd, "D", "OK");
+  close(fd);
+
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+int main() {
+  test_gdb_session();
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include "../include/json.h"
+#include <assert.h>
+#include <string.h>
+
+void test_parse_json_object() {
+  Json_Object object;
+  assert(parse_json_object(" {\"id\": 7, \"cmd\":\"memory\", \"addr\" : "
+                           "-12,\"all\":true, \"x\":null}\n",
+                           &object));
+  assert(object.num_members == 5);
+  int64_t num;
+  assert(json_get_num(&object, "id", &num) && num == 7);
+  assert(json_get_num(&object, "addr", &num) && num == -12);
+  assert(strcmp(json_get_str(&object, "cmd"), "memory") == 0);
+  assert(json_member(&object, "all")->type == JSON_BOOL);
+  assert(json_member(&object, "all")->num == true);
+  assert(json_member(&object, "x")->type == JSON_NULL);
+  assert(json_get_str(&object, "id") == NULL);
+  assert(json_member(&object, "missing") == NULL);
+
+  assert(parse_json_object("{}", &object) && object.num_members == 0);
+  assert(parse_json_object("{\"s\":\"a\\\"b\\\\c\\n\\u0041\"}", &object));
+  assert(strcmp(json_get_str(&object, "s"), "a\"b\\c\nA") == 0);
+}
+
+void test_parse_invalid_json_object() {
+  Json_Object object;
+  assert(!parse_json_object("", &object));
+  assert(!parse_json_object("[1]", &object));
+  assert(!parse_json_object("{\"a\":1", &object));
+  assert(!parse_json_object("{\"a\":1,}", &object));
+  assert(!parse_json_object("{\"a\":1} x", &object));
+  assert(!parse_json_object("{\"a\":1.5}", &object));
+  assert(!parse_json_object("{\"a\":[1]}", &object));
+  assert(!parse_json_object("{\"a\":\"\\x\"}", &object));
+  assert(!parse_json_object("{\"a_key_that_is_too_long\":1}", &object));
+}
+
+void test_parse_json() {
+  Json_Value *value = parse_json(
+      "{\"seq\": 3, \"arguments\": {\"source\": {\"path\": \"a.reti\"}, "
+      "\"breakpoints\": [{\"line\": 7}, {\"line\": 2.5}, []]}, "
+      "\"ok\": false}");
+  assert(value && value->type == JSON_OBJECT && value->num_children == 3);
+  int64_t num;
+  assert(json_value_num(json_get(value, "seq"), &num) && num == 3);
+  const Json_Value *arguments = json_get(value, "arguments");
+  assert(strcmp(json_value_str(json_get(json_get(arguments, "source"), "path")),
+                "a.reti") == 0);
+  const Json_Value *breakpoints = json_get(arguments, "breakpoints");
+  assert(breakpoints->type == JSON_ARRAY && breakpoints->num_children == 3);
+  assert(json_value_num(json_get(&breakpoints->children[0], "line"), &num) &&
+         num == 7);
+  assert(json_value_num(json_get(&breakpoints->children[1], "line"), &num) &&
+         num == 2);
+  assert(breakpoints->children[2].num_children == 0);
+  assert(json_get(value, "ok")->type == JSON_BOOL);
+  assert(json_get(value, "missing") == NULL);
+  assert(json_value_str(json_get(value, "seq")) == NULL);
+  free_json(value);
+
+  assert(!parse_json("{\"a\": [1, 2}"));
+  assert(!parse_json("{\"a\" 1}"));
+  assert(!parse_json("[1] x"));
+  assert(!parse_json("[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]]]]]]]"
+                     "]]]]]]]]"));
+}
+
+void test_json_writer() {
+  Json_Writer writer = {NULL, 0, 0};
+  json_begin_object(&writer, NULL);
+  json_int(&writer, "id", -1);
+  json_begin_array(&writer, "values");
+  json_uint(&writer, NULL, 4294967295);
+  json_uint(&writer, NULL, 0);
+  json_end_array(&writer);
+  json_begin_object(&writer, "empty");
+  json_end_object(&writer);
+  json_str(&writer, "s", "a\"b\\\n\x01");
+  json_bool(&writer, "ok", true);
+  json_null(&writer, "n");
+  json_end_object(&writer);
+  assert(strncmp(writer.data,
+                 "{\"id\":-1,\"values\":[4294967295,0],\"empty\":{},"
+                 "\"s\":\"a\\\"b\\\\\\n\\u0001\",\"ok\":true,\"n\":null}",
+                 writer.len) == 0);
+
+  json_reset(&writer);
+  json_begin_object(&writer, NULL);
+  json_end_object(&writer);
+  assert(writer.len == 2 && strncmp(writer.data, "{}", 2) == 0);
+  fin_json_writer(&writer);
+}
+
+int main() {
+  test_parse_json_object();
+  test_parse_invalid_json_object();
+  test_parse_json();
+  test_json_writer();
+
+  return 0;
+}
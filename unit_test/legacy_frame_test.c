@@ -0,0 +1,90 @@
+#include "../include/input_output.h"
+#include "../include/legacy_frame.h"
+#include "../include/parse_args.h"
+#include "../include/utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// returns what the frame wrote to stdout
+char *write_frame() {
+  FILE *original_stdout = stdout;
+  stdout = tmpfile();
+  write_legacy_frame();
+  long len = ftell(stdout);
+  char *output = malloc(len + 1);
+  rewind(stdout);
+  assert(fread(output, 1, len, stdout) == (size_t)len);
+  output[len] = '\0';
+  fclose(stdout);
+  stdout = original_stdout;
+  return output;
+}
+
+void expect_frame(const char *expected) {
+  char *output = write_frame();
+  assert(strcmp(output, expected) == 0);
+  free(output);
+}
+
+void test_diff() {
+  legacy_diff_active = true;
+  debug_script_active = false;
+
+  // the first frame starts on a cleared screen
+  legacy_print("PC %u\n", 0);
+  legacy_print("ACC %d\n", 1);
+  legacy_print("IN1 %d\n", 2);
+  expect_frame("\033[1;1H\033[2J"
+               "\033[1;1HPC 0\033[K"
+               "\033[2;1HACC 1\033[K"
+               "\033[3;1HIN1 2\033[K"
+               "\033[4;1H\033[J");
+
+  // only the changed line is positioned and written
+  legacy_print("PC 0\nACC 10\nIN1 2\n");
+  expect_frame("\033[2;1HACC 10\033[K"
+               "\033[4;1H\033[J");
+
+  legacy_print("PC 0\nACC 10\nIN1 2\n");
+  expect_frame("\033[4;1H\033[J");
+
+  // below a shorter frame the rest of the last one is cleared
+  legacy_print("PC 0\n");
+  expect_frame("\033[2;1H\033[J");
+
+  legacy_print("PC 1\nACC 10\n");
+  expect_frame("\033[1;1HPC 1\033[K"
+               "\033[2;1HACC 10\033[K"
+               "\033[3;1H\033[J");
+}
+
+// the buffer starts empty and has to grow by small and by large prints
+void test_growing_buffer() {
+  legacy_diff_active = false;
+  char *expected = malloc(4 * INITIAL_BUFFER_SIZE);
+  size_t len = 0;
+  for (uint32_t i = 0; i < 200; i++) {
+    legacy_print("line %u\n", i);
+    len += sprintf(expected + len, "line %u\n", i);
+  }
+  char large[2 * INITIAL_BUFFER_SIZE + 1];
+  memset(large, 'x', sizeof(large) - 1);
+  large[sizeof(large) - 1] = '\0';
+  legacy_print("%s", large);
+  len += sprintf(expected + len, "%s", large);
+  assert(len > 3 * INITIAL_BUFFER_SIZE);
+  expect_frame(expected);
+
+  // the buffers are reused for the next frame
+  legacy_print("short\n");
+  expect_frame("short\n");
+  free(expected);
+}
+
+int main() {
+  test_diff();
+  test_growing_buffer();
+  return 0;
+}
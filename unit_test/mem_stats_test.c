@@ -0,0 +1,96 @@
+#include "../include/debug.h"
+#include "../include/mem_stats.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setup_stats() {
+  regs = calloc(NUM_REGISTERS, sizeof(uint32_t));
+  page_size = 16;
+  sram_size = 64;
+  // the heatmap is only counted for the Ncurses Debug TUI
+  heatmap_active = true;
+  debug_mode = true;
+  legacy_debug_tui = false;
+  init_mem_stats();
+}
+
+// below DS lies the code, above SP the stack
+void test_mem_type_of_addr() {
+  regs[DS] = 0x80000000 | 16;
+  regs[SP] = 0x80000000 | 40;
+  assert(mem_type_of_addr(5) == EPROM);
+  assert(mem_type_of_addr(0x40000001) == UART);
+  assert(mem_type_of_addr(0x80000003) == SRAM_C);
+  assert(mem_type_of_addr(0x80000010) == SRAM_D);
+  assert(mem_type_of_addr(0x80000028) == SRAM_D);
+  assert(mem_type_of_addr(0x80000029) == SRAM_S);
+}
+
+void record_n(uint32_t addr, bool is_write, uint32_t n) {
+  for (uint32_t i = 0; i < n; i++) {
+    record_mem_access(addr, is_write);
+  }
+}
+
+void test_heat_levels() {
+  record_n(0x80000014, false, 1);
+  record_n(0x80000015, false, 10);
+  record_n(0x80000016, false, 100);
+  record_n(0x80000017, false, 100000);
+  assert(heat_level_of_sram_cell(0x13) == 0);
+  assert(heat_level_of_sram_cell(0x14) == 1);
+  assert(heat_level_of_sram_cell(0x15) == 2);
+  assert(heat_level_of_sram_cell(0x16) == 3);
+  assert(heat_level_of_sram_cell(0x17) == NUM_HEAT_LEVELS);
+  assert(heat_level_of_sram_cell(sram_size) == 0);
+}
+
+char *print_to_string() {
+  FILE *original_stderr = stderr;
+  stderr = tmpfile();
+  print_mem_stats();
+  long len = ftell(stderr);
+  char *output = malloc(len + 1);
+  rewind(stderr);
+  assert(fread(output, 1, len, stderr) == (size_t)len);
+  output[len] = '\0';
+  fclose(stderr);
+  stderr = original_stderr;
+  return output;
+}
+
+// continues with the accesses of test_heat_levels in SRAM page 1
+void test_print_mem_stats() {
+  record_n(5, false, 3);
+  record_n(0x40000000, true, 1);
+  record_n(0x80000003, false, 4);
+  record_n(0x80000003, true, 2);
+  char *output = print_to_string();
+
+  assert(strstr(output, "(page size 16)"));
+  assert(strstr(output, "SRAM Codesegment           4 reads          2 writes"
+                        "  read/write ratio 2.00\n"));
+  assert(strstr(output, "SRAM Datasegment      100111 reads          0 writes"
+                        "\n"));
+  assert(strstr(output, "Working set: 4 pages, thereof 2 SRAM pages "
+                        "(32 words)\n"));
+  // the hottest page comes first
+  assert(strstr(output, "Hot pages:\n  SRAM page 1 (16-31): 100111 reads, 0 "
+                        "writes\n"));
+  assert(strstr(output, "  EPROM page 0 (0-15): 3 reads, 0 writes\n"));
+  assert(strstr(output, "  UART: 0 reads, 1 writes\n"));
+  assert(strstr(output, "  SRAM page 0 (0-15): 4 reads, 2 writes\n"));
+  free(output);
+}
+
+int main() {
+  setup_stats();
+  test_mem_type_of_addr();
+  test_heat_levels();
+  test_print_mem_stats();
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include "../include/breakpoints.h"
 #include "../include/debug.h"
 #include "../include/parse_instrs.h"
 #include "../include/parse_args.h"
@@ -55,11 +56,36 @@ void test_parse_and_load_program2() {
   fin_reti();
 }
 
+// each file has its own lines, the SRAM program is covered by the tests above
+void test_line_addrs_of_isrs_and_eprom() {
+  peripherals_dir = "/tmp";
+  init_reti();
+  uint32_t sram_start = (uint32_t)SRAM_CONST << 30;
+  parse_and_load_program(
+      allocate_and_copy_string("IVTE 2\nIVTE 3\n\nRTI\n  RTI"), ISR_PRGRMS);
+  parse_and_load_program(
+      allocate_and_copy_string("LOADI ACC 1\n# comment\nJUMP 0"),
+      EPROM_START_PRGRM);
+  assert(parse_breakpoint_location("li4") == (sram_start | 2));
+  assert(parse_breakpoint_location("li3") == NO_ADDR);
+  assert(parse_breakpoint_location("le3") == 1);
+  assert(parse_breakpoint_location("le") == NO_ADDR);
+
+  Program_Type prgrm_type;
+  assert(line_of_addr(sram_start | 3, &prgrm_type) == 5);
+  assert(prgrm_type == ISR_PRGRMS);
+  assert(line_of_addr(1, &prgrm_type) == 3);
+  assert(prgrm_type == EPROM_START_PRGRM);
+  assert(line_of_addr(2, &prgrm_type) == 0);
+  fin_reti();
+}
+
 int main() {
   test_parse_instr();
   test_parse_instr2();
   test_parse_instr3();
   test_parse_and_load_program();
   test_parse_and_load_program2();
+  test_line_addrs_of_isrs_and_eprom();
   return 0;
 }
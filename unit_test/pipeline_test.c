@@ -0,0 +1,111 @@
+#include "../include/interpr.h"
+#include "../include/parse_args.h"
+#include "../include/parse_instrs.h"
+#include "../include/pipeline.h"
+#include "../include/reti.h"
+#include "../include/utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void setup_machine(const char *prgrm) {
+  FILE *input_stream = fmemopen((void *)prgrm, strlen(prgrm), "r");
+  if (input_stream == NULL) {
+    fprintf(stderr, "Error: fmemopen failed\n");
+    exit(EXIT_FAILURE);
+  }
+  FILE *original_stdin = stdin;
+  stdin = input_stream;
+
+  parse_args(4, (char *[]){"", "-f", "/tmp", "-"});
+  init_reti();
+  load_adjusted_eprom_prgrm();
+  parse_and_load_program(get_prgrm_content(sram_prgrm_path), SRAM_PRGRM);
+
+  fclose(input_stream);
+  stdin = original_stdin;
+}
+
+// like the interpreter the PC is already at the next instruction
+static void feed(uint8_t op, uint32_t opd1, uint32_t opd2, uint32_t next_pc) {
+  Instruction instr = {.op = op, .opd1 = opd1, .opd2 = opd2};
+  uint32_t pc = regs[PC];
+  regs[PC] = next_pc;
+  pipeline_instr(pc, &instr);
+}
+
+void test_data_hazards() {
+  regs[PC] = 0;
+  init_pipeline();
+  feed(LOADI, ACC, 1, 1);
+  feed(ADDI, ACC, 1, 2);
+  // forwarding from EX to EX removes the stall
+  assert(with_forwarding.data_stalls == 0);
+  assert(with_forwarding.forwards == 1);
+  assert(pipeline_cycles(&with_forwarding) == 6);
+  assert(without_forwarding.data_stalls == 2);
+  assert(pipeline_cycles(&without_forwarding) == 8);
+
+  // a value from memory is forwarded from MEM a cycle later
+  feed(LOAD, ACC, 5, 3);
+  feed(ADDI, ACC, 1, 4);
+  assert(with_forwarding.data_stalls == 1);
+  assert(with_forwarding.control_stalls == 0);
+}
+
+void test_control_hazards() {
+  regs[PC] = 0;
+  regs[ACC] = 0;
+  init_pipeline();
+  feed(JUMP, 5, 0, 5);
+  assert(with_forwarding.control_stalls == JUMP_PENALTY);
+  // a taken jump to the next address still flushes the pipeline
+  feed(JUMPEQ, 1, 0, 6);
+  assert(with_forwarding.control_stalls == JUMP_PENALTY + EX_PC_WRITE_PENALTY);
+  feed(JUMPNE, 4, 0, 7);
+  assert(with_forwarding.control_stalls == JUMP_PENALTY + EX_PC_WRITE_PENALTY);
+  assert(without_forwarding.control_stalls ==
+         with_forwarding.control_stalls);
+
+  // an interrupt of a device redirects the PC between two instructions
+  regs[PC] = 42;
+  feed(NOP, 0, 0, 43);
+  assert(with_forwarding.control_stalls ==
+         JUMP_PENALTY + 2 * EX_PC_WRITE_PENALTY);
+  assert(pipeline_instrs == 4);
+}
+
+static void run_with_pipeline(const char *prgrm) {
+  setup_machine(prgrm);
+  pipeline_active = true;
+  init_pipeline();
+  interpr_prgrm();
+  pipeline_active = false;
+}
+
+// the breakpoint of the debugger is an instruction like NOP for the pipeline
+void test_breakpoint_instr() {
+  run_with_pipeline("NOP;"
+                    "LOADI ACC 1;"
+                    "JUMP 0");
+  uint64_t num_instrs = pipeline_instrs;
+  uint64_t control_stalls = with_forwarding.control_stalls;
+  uint64_t cycles = pipeline_cycles(&with_forwarding);
+
+  run_with_pipeline("INT 3;"
+                    "LOADI ACC 1;"
+                    "JUMP 0");
+  assert(pipeline_instrs == num_instrs);
+  assert(with_forwarding.control_stalls == control_stalls);
+  assert(pipeline_cycles(&with_forwarding) == cycles);
+}
+
+int main() {
+  setup_machine("JUMP 0");
+  test_data_hazards();
+  test_control_hazards();
+  test_breakpoint_instr();
+
+  return 0;
+}
@@ -0,0 +1,175 @@
+#include "../include/protocol.h"
+#include "../include/breakpoints.h"
+#include "../include/parse_args.h"
+#include "../include/parse_instrs.h"
+#include "../include/reti.h"
+#include "../include/undo.h"
+#include "../include/utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char *output = NULL;
+
+static void setup_machine() {
+  peripherals_dir = "/tmp";
+  init_reti();
+  init_breakpoints();
+  parse_and_load_program(
+      allocate_and_copy_string("LOADI ACC 42\nLOADI IN1 1\nJUMP 0"),
+      SRAM_PRGRM);
+  init_undo();
+}
+
+// feeds the requests on stdin and keeps what was sent on stdout
+static void run_requests(const char *requests, char *input) {
+  FILE *input_stream = fmemopen((void *)requests, strlen(requests), "r");
+  assert(input_stream);
+  FILE *original_stdin = stdin, *original_stdout = stdout;
+  stdin = input_stream;
+  stdout = tmpfile();
+  if (input) {
+    read_protocol_input(input, "Enter a number", 3);
+  } else {
+    evaluate_protocol_requests();
+  }
+  long len = ftell(stdout);
+  free(output);
+  output = malloc(len + 1);
+  rewind(stdout);
+  assert(fread(output, 1, len, stdout) == (size_t)len);
+  output[len] = '\0';
+  fclose(stdout);
+  fclose(input_stream);
+  stdin = original_stdin;
+  stdout = original_stdout;
+}
+
+static void expect_line(const char *line) {
+  char *pos = strstr(output, line);
+  assert(pos && pos[strlen(line)] == '\n');
+}
+
+void test_memory() {
+  run_requests("{\"id\":1,\"cmd\":\"memory\",\"addr\":-1,\"count\":1}\n"
+               "{\"id\":2,\"cmd\":\"memory\",\"addr\":4294967296,"
+               "\"count\":1}\n"
+               "{\"id\":3,\"cmd\":\"memory\",\"addr\":0,\"count\":0}\n"
+               "{\"id\":4,\"cmd\":\"memory\",\"addr\":0,\"count\":4097}\n"
+               "{\"id\":5,\"cmd\":\"memory\",\"addr\":2147549183,"
+               "\"count\":2}\n"
+               "{\"id\":6,\"cmd\":\"memory\",\"addr\":1073741826,"
+               "\"count\":2}\n"
+               "{\"id\":7,\"cmd\":\"memory\",\"addr\":1073741824,"
+               "\"count\":3}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line("{\"id\":1,\"ok\":false,\"error\":\"Invalid address\"}");
+  expect_line("{\"id\":2,\"ok\":false,\"error\":\"Invalid address\"}");
+  expect_line("{\"id\":3,\"ok\":false,"
+              "\"error\":\"Count must be between 1 and 4096\"}");
+  expect_line("{\"id\":4,\"ok\":false,"
+              "\"error\":\"Count must be between 1 and 4096\"}");
+  // the last cell of the SRAM and one behind it
+  expect_line("{\"id\":5,\"ok\":false,\"error\":\"Range exceeds the memory\"}");
+  expect_line("{\"id\":6,\"ok\":false,\"error\":\"Range exceeds the memory\"}");
+  expect_line("{\"id\":7,\"addr\":1073741824,\"values\":[0,0,3],\"ok\":true}");
+}
+
+void test_step_back() {
+  regs[ACC] = 1;
+  for (uint32_t i = 2; i <= 3; i++) {
+    undo_instr_begin();
+    regs[ACC] = i;
+    undo_instr_end();
+  }
+  run_requests("{\"id\":1,\"cmd\":\"step_back\",\"count\":3}\n"
+               "{\"id\":2,\"cmd\":\"step_back\",\"count\":-1}\n"
+               "{\"id\":3,\"cmd\":\"step_back\",\"count\":\"x\"}\n"
+               "{\"id\":4,\"cmd\":\"step_back\",\"count\":2}\n"
+               "{\"id\":5,\"cmd\":\"step_back\"}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line("{\"id\":1,\"ok\":false,"
+              "\"error\":\"Not that many instructions to undo\"}");
+  expect_line("{\"id\":2,\"ok\":false,"
+              "\"error\":\"Not that many instructions to undo\"}");
+  expect_line("{\"id\":3,\"ok\":false,\"error\":\"Invalid number of steps\"}");
+  expect_line("{\"id\":4,\"ok\":true}");
+  expect_line("{\"id\":5,\"ok\":false,"
+              "\"error\":\"Not that many instructions to undo\"}");
+  assert(regs[ACC] == 1);
+}
+
+// without a condition the breakpoint is toggled, with one it stays set
+void test_breakpoint() {
+  uint32_t addr = parse_breakpoint_location("l2");
+  assert(addr != NO_ADDR);
+  char set[64], unset[64];
+  snprintf(set, sizeof(set), "\"addr\":%u,\"set\":true,\"ok\":true}", addr);
+  snprintf(unset, sizeof(unset), "\"addr\":%u,\"set\":false,\"ok\":true}",
+           addr);
+  run_requests("{\"id\":1,\"cmd\":\"breakpoint\",\"location\":\"l2\"}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line(set);
+  assert(is_breakpoint(addr));
+  run_requests("{\"id\":2,\"cmd\":\"breakpoint\",\"location\":\"l2\"}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line(unset);
+  assert(!is_breakpoint(addr));
+
+  run_requests("{\"id\":3,\"cmd\":\"breakpoint\",\"location\":\"l2\","
+               "\"condition\":\"ACC == 42\"}\n"
+               "{\"id\":4,\"cmd\":\"breakpoint\",\"location\":\"l2\","
+               "\"condition\":\"ACC ==\"}\n"
+               "{\"id\":5,\"cmd\":\"breakpoint\",\"location\":\"l9\"}\n"
+               "{\"id\":6,\"cmd\":\"breakpoint\"}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line(set);
+  assert(is_breakpoint(addr));
+  expect_line("{\"id\":4,\"ok\":false,\"error\":\"Invalid condition\"}");
+  expect_line("{\"id\":5,\"ok\":false,"
+              "\"error\":\"No instruction at this address or line\"}");
+  expect_line("{\"id\":6,\"ok\":false,"
+              "\"error\":\"No instruction at this address or line\"}");
+}
+
+// while an instruction waits for input only the requests that don't run the
+// machine are answered
+void test_pending_input() {
+  char input[4];
+  run_requests("{\"id\":1,\"cmd\":\"step\"}\n"
+               "{\"id\":2,\"cmd\":\"step_back\"}\n"
+               "{\"id\":3,\"cmd\":\"registers\"}\n"
+               "{\"id\":4,\"cmd\":\"input\",\"value\":\"1234\"}\n"
+               "{\"id\":5,\"cmd\":\"input\",\"value\":\"123\"}\n",
+               input);
+  expect_line("{\"event\":\"input\",\"message\":\"Enter a number\"}");
+  expect_line("{\"id\":1,\"ok\":false,\"error\":\"Waiting for input\"}");
+  expect_line("{\"id\":2,\"ok\":false,\"error\":\"Waiting for input\"}");
+  assert(strstr(output, "{\"id\":3,\"registers\":{"));
+  expect_line("{\"id\":4,\"ok\":false,\"error\":\"Input too long\"}");
+  expect_line("{\"id\":5,\"ok\":true}");
+  assert(strcmp(input, "123") == 0);
+
+  // afterwards nothing is waiting anymore
+  run_requests("{\"id\":6,\"cmd\":\"input\",\"value\":\"1\"}\n"
+               "{\"cmd\":\"continue\"}\n",
+               NULL);
+  expect_line("{\"id\":6,\"ok\":false,"
+              "\"error\":\"No instruction is waiting for input\"}");
+}
+
+int main() {
+  setup_machine();
+  test_memory();
+  test_step_back();
+  test_breakpoint();
+  test_pending_input();
+  free(output);
+  return 0;
+}
@@ -0,0 +1,54 @@
+#include "../include/interpr.h"
+#include "../include/record.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void test_seeded_prng() {
+  seed = 42;
+  init_record();
+  uint32_t first = machine_rand();
+  uint32_t second = machine_rand();
+  assert(first != second);
+
+  init_record();
+  assert(machine_rand() == first);
+  assert(machine_rand() == second);
+
+  seed = 43;
+  init_record();
+  assert(machine_rand() != first);
+}
+
+void test_record_and_replay() {
+  seed = 7;
+  record_active = true;
+  record_path = "/tmp/record_test.txt";
+  init_record();
+  uint32_t values[3];
+  for (uint8_t i = 0; i < 3; i++) {
+    num_executed_instrs = i * 10;
+    values[i] = machine_rand();
+  }
+  fin_record();
+  record_active = false;
+
+  // another seed must not matter, the values come from the recording
+  seed = 8;
+  replay_active = true;
+  replay_path = "/tmp/record_test.txt";
+  init_record();
+  assert(seed == 7);
+  for (uint8_t i = 0; i < 3; i++) {
+    num_executed_instrs = i * 10;
+    assert(machine_rand() == values[i]);
+  }
+  fin_record();
+  replay_active = false;
+}
+
+int main() {
+  test_seeded_prng();
+  test_record_and_replay();
+  return 0;
+}
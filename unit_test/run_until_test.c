@@ -0,0 +1,120 @@
+#include "../include/run_until.h"
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/parse_args.h"
+#include "../include/parse_instrs.h"
+#include "../include/reti.h"
+#include "../include/uart.h"
+#include "../include/utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// INT 0 of the ISRs prints ACC over the UART and returns with RTI
+static void setup_machine() {
+  const char *prgrm = "LOADI ACC 42;"
+                      "INT 0;"
+                      "JUMP 0";
+  FILE *input_stream = fmemopen((void *)prgrm, strlen(prgrm), "r");
+  if (input_stream == NULL) {
+    fprintf(stderr, "Error: fmemopen failed\n");
+    exit(EXIT_FAILURE);
+  }
+  FILE *original_stdin = stdin;
+  stdin = input_stream;
+
+  parse_args(6, (char *[]){"", "-f", "/tmp", "-i", "./run/isrs.reti", "-"});
+  init_reti();
+  load_adjusted_eprom_prgrm();
+  parse_and_load_program(get_prgrm_content(isrs_prgrm_path), ISR_PRGRMS);
+  parse_and_load_program(get_prgrm_content(sram_prgrm_path), SRAM_PRGRM);
+
+  fclose(input_stream);
+  stdin = original_stdin;
+}
+
+void test_parse_run_until() {
+  assert(parse_run_until("n 5"));
+  assert(parse_run_until("p 42"));
+  assert(parse_run_until("r acc"));
+  assert(parse_run_until("r DS"));
+  assert(parse_run_until("o"));
+  assert(parse_run_until("i"));
+
+  assert(!parse_run_until("n 0"));
+  assert(!parse_run_until("n -1"));
+  assert(!parse_run_until("n 4294967296"));
+  assert(!parse_run_until("n"));
+  assert(!parse_run_until("n5"));
+  assert(!parse_run_until("p"));
+  assert(!parse_run_until("p x"));
+  // only the registers of the instructions can be watched
+  assert(!parse_run_until("r INTTIMER"));
+  assert(!parse_run_until("r XYZ"));
+  assert(!parse_run_until("o 1"));
+  assert(!parse_run_until("i 1"));
+  assert(!parse_run_until("x"));
+  assert(!parse_run_until(""));
+  run_until_active = false;
+}
+
+static bool reached_after_check() {
+  breakpoint_encountered = false;
+  check_run_until();
+  return !run_until_active && breakpoint_encountered;
+}
+
+void test_check_run_until() {
+  num_executed_instrs = 10;
+  assert(parse_run_until("n 3"));
+  num_executed_instrs = 12;
+  assert(!reached_after_check());
+  num_executed_instrs = 13;
+  assert(reached_after_check());
+
+  regs[PC] = 0;
+  assert(parse_run_until("p 7"));
+  assert(!reached_after_check());
+  regs[PC] = 7;
+  assert(reached_after_check());
+
+  regs[ACC] = 1;
+  assert(parse_run_until("r ACC"));
+  regs[IN1] = 2;
+  assert(!reached_after_check());
+  regs[ACC] = 2;
+  assert(reached_after_check());
+}
+
+// the program stops with JUMP 0, so a run until that is still active after
+// it was never reached
+void test_uart_output() {
+  setup_machine();
+  uint64_t outputs_before = num_uart_outputs;
+  assert(parse_run_until("o"));
+  assert(!reached_after_check());
+  interpr_prgrm();
+  assert(!run_until_active);
+  assert(num_uart_outputs == outputs_before + 1);
+}
+
+void test_isr_return() {
+  setup_machine();
+  uint64_t returns_before = num_isr_returns;
+  assert(parse_run_until("i"));
+  assert(!reached_after_check());
+  interpr_prgrm();
+  assert(!run_until_active);
+  assert(num_isr_returns == returns_before + 1);
+}
+
+int main() {
+  setup_machine();
+  test_parse_run_until();
+  test_check_run_until();
+  test_uart_output();
+  test_isr_return();
+
+  return 0;
+}
@@ -0,0 +1,81 @@
+#include "../include/debug.h"
+#include "../include/interpr.h"
+#include "../include/interrupt_controller.h"
+#include "../include/reti.h"
+#include "../include/shm_export.h"
+#include "../include/uart.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static char name[32];
+static const Shm_State *reader;
+
+// maps the segment like a viewer in another process would
+void test_init() {
+  regs = calloc(NUM_REGISTERS, sizeof(uint32_t));
+  uart = calloc(NUM_UART_ADDRESSES, sizeof(uint8_t));
+  snprintf(name, sizeof(name), "/reti_test_%d", getpid());
+  shm_export_name = name;
+  init_shm_export();
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  assert(fd >= 0);
+  reader = mmap(NULL, sizeof(Shm_State), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  assert(reader != MAP_FAILED);
+  assert(reader->magic == SHM_EXPORT_MAGIC);
+  assert(reader->version == SHM_EXPORT_VERSION);
+  assert(reader->seq == 2);
+  assert(reader->stack_top == -1 && !reader->finished);
+}
+
+void test_publish() {
+  regs[ACC] = 42;
+  regs[PC] = 0x80000003;
+  uart[0] = 'R';
+  stack_top = 1;
+  isr_priority_stack[1] = 5;
+  current_isr = 2;
+  isr_active = true;
+  num_executed_instrs = 1000;
+  num_isr_returns = 3;
+  publish_shm_state();
+  assert(reader->seq == 4);
+  assert(reader->regs[ACC] == 42 && reader->regs[PC] == 0x80000003);
+  assert(reader->uart[0] == 'R');
+  assert(reader->stack_top == 1 && reader->isr_priority_stack[1] == 5);
+  assert(reader->current_isr == 2 && reader->isr_active);
+  assert(reader->num_executed_instrs == 1000);
+  assert(reader->num_isr_returns == 3);
+}
+
+// while running only every SHM_UPDATE_INTERVAL-th instruction publishes
+void test_update_interval() {
+  regs[ACC] = 43;
+  for (uint32_t i = 1; i < SHM_UPDATE_INTERVAL; i++) {
+    check_shm_export();
+  }
+  assert(reader->seq == 4 && reader->regs[ACC] == 42);
+  check_shm_export();
+  assert(reader->seq == 6 && reader->regs[ACC] == 43);
+}
+
+// an attached viewer keeps the final state, the name is gone
+void test_fin() {
+  fin_shm_export();
+  assert(reader->seq == 8 && reader->finished);
+  assert(shm_open(name, O_RDONLY, 0) < 0);
+  munmap((void *)reader, sizeof(Shm_State));
+}
+
+int main() {
+  test_init();
+  test_publish();
+  test_update_interval();
+  test_fin();
+  return 0;
+}
@@ -0,0 +1,101 @@
+#include "../include/assemble.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include "../include/snapshot.h"
+#include "../include/uart.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setup_machine() {
+  regs = malloc(sizeof(uint32_t) * NUM_REGISTERS);
+  memset(regs, 0, sizeof(uint32_t) * NUM_REGISTERS);
+  num_instrs_start_prgrm = 2;
+  eprom = malloc(sizeof(uint32_t) * num_instrs_start_prgrm);
+  eprom[0] = 0x70c00007;
+  eprom[1] = 0xf8000000;
+  sram = tmpfile();
+  init_uart();
+  isr_num = 1;
+  isr_to_prio = malloc(1);
+  isr_to_prio[0] = 3;
+}
+
+void test_snapshot_roundtrip() {
+  regs[ACC] = 42;
+  regs[PC] = 0x80000002;
+  write_file(sram, 0, 7);
+  write_file(sram, 3, 9);
+  timer_cnt = 5;
+  stack_top = 0;
+  isr_priority_stack[0] = 3;
+
+  Snapshot snapshot = {0};
+  take_snapshot(&snapshot);
+
+  regs[ACC] = 0;
+  eprom[1] = 0;
+  write_file(sram, 3, 1);
+  // written after the snapshot, has to be 0 again afterwards
+  write_file(sram, 100, 1);
+  uart[0] = 'x';
+  timer_cnt = 0;
+  stack_top = -1;
+
+  assert(restore_snapshot(&snapshot));
+  assert(regs[ACC] == 42);
+  assert(regs[PC] == 0x80000002);
+  assert(eprom[0] == 0x70c00007 && eprom[1] == 0xf8000000);
+  assert(read_file(sram, 0) == 7);
+  assert(read_file(sram, 3) == 9);
+  assert(read_file(sram, 100) == 0);
+  assert(uart[0] == 0 && uart[2] == 0b00000011);
+  assert(timer_cnt == 5);
+  assert(stack_top == 0 && isr_priority_stack[0] == 3);
+  assert(isr_num == 1 && isr_to_prio[0] == 3);
+  free_snapshot(&snapshot);
+}
+
+void test_snapshot_file() {
+  regs[IN1] = 13;
+  save_snapshot("/tmp/snapshot_test.snap");
+  regs[IN1] = 0;
+  load_snapshot("/tmp/snapshot_test.snap");
+  assert(regs[IN1] == 13);
+}
+
+void test_invalid_snapshot() {
+  Snapshot snapshot = {0};
+  take_snapshot(&snapshot);
+  snapshot.data[0] = 'X';
+  assert(!restore_snapshot(&snapshot));
+  snapshot.data[0] = 'R';
+  snapshot.len /= 2;
+  assert(!restore_snapshot(&snapshot));
+  free_snapshot(&snapshot);
+}
+
+// writes behind the end of the SRAM are undone too
+void test_restart_behind_sram() {
+  write_file(sram, 5, 11);
+  init_restart_snapshot();
+  write_storage((uint32_t)SRAM_CONST << 30 | 5, 12);
+  write_storage((uint32_t)SRAM_CONST << 30 | (sram_size + 10), 99);
+  restart_from_snapshot();
+  assert(read_file(sram, 5) == 11);
+  fseek(sram, 0, SEEK_END);
+  assert(ftell(sram) == (long)sram_size * (long)sizeof(uint32_t));
+}
+
+int main() {
+  setup_machine();
+  test_snapshot_roundtrip();
+  test_snapshot_file();
+  test_invalid_snapshot();
+  test_restart_behind_sram();
+  fclose(sram);
+  return 0;
+}
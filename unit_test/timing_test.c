@@ -0,0 +1,130 @@
+#include "../include/assemble.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/reti.h"
+#include "../include/timing.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+char config_path[] = "/tmp/timing_test_XXXXXX";
+
+void write_config(const char *config) {
+  int fd = mkstemp(config_path);
+  assert(fd >= 0);
+  assert(write(fd, config, strlen(config)) == (ssize_t)strlen(config));
+  close(fd);
+  timing_path = config_path;
+}
+
+// mkstemp needs the placeholder again for the next config
+void remove_config() {
+  unlink(config_path);
+  strcpy(config_path + strlen(config_path) - 6, "XXXXXX");
+}
+
+// init_timing exits on errors, so it runs in a child process
+bool config_is_rejected(const char *config) {
+  write_config(config);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    assert(freopen("/dev/null", "w", stderr));
+    init_timing();
+    exit(EXIT_SUCCESS);
+  }
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  remove_config();
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE;
+}
+
+void test_config() {
+  write_config("# latencies of a slow SRAM\n"
+               "\n"
+               "load 4 # two accesses\n"
+               "  sram\t3\n"
+               "mispredict 2\n");
+  init_timing();
+  remove_config();
+  assert(latencies[TIMING_LOAD] == 4);
+  assert(latencies[TIMING_SRAM] == 3);
+  assert(latencies[TIMING_MISPREDICT] == 2);
+  assert(latencies[TIMING_STORE] == 1 && latencies[TIMING_EPROM] == 0);
+}
+
+void test_invalid_configs() {
+  assert(config_is_rejected("lod 4\n"));
+  assert(config_is_rejected("load\n"));
+  assert(config_is_rejected("load x\n"));
+  assert(config_is_rejected("load -1\n"));
+  assert(config_is_rejected("load 4294967296\n"));
+  assert(config_is_rejected("load 4 5\n"));
+  assert(!config_is_rejected("load 4294967295\n"));
+}
+
+void test_instr_classes() {
+  assert(instr_class_of_op(ADDI) == TIMING_COMPUTE_I);
+  assert(instr_class_of_op(ANDI) == TIMING_COMPUTE_I);
+  assert(instr_class_of_op(ADDR) == TIMING_COMPUTE_R);
+  assert(instr_class_of_op(ANDR) == TIMING_COMPUTE_R);
+  assert(instr_class_of_op(ADDM) == TIMING_COMPUTE_M);
+  assert(instr_class_of_op(ANDM) == TIMING_COMPUTE_M);
+  assert(instr_class_of_op(LOAD) == TIMING_LOAD);
+  assert(instr_class_of_op(LOADIN) == TIMING_LOAD);
+  assert(instr_class_of_op(LOADI) == TIMING_LOADI);
+  assert(instr_class_of_op(STORE) == TIMING_STORE);
+  assert(instr_class_of_op(STOREIN) == TIMING_STORE);
+  assert(instr_class_of_op(MOVE) == TIMING_MOVE);
+  assert(instr_class_of_op(NOP) == TIMING_NOP);
+  assert(instr_class_of_op(INT) == TIMING_INT);
+  assert(instr_class_of_op(RTI) == TIMING_RTI);
+  assert(instr_class_of_op(JUMPGT) == TIMING_JUMP);
+  assert(instr_class_of_op(JUMP) == TIMING_JUMP);
+}
+
+void run_load(uint32_t addr) {
+  timing_instr_begin();
+  timing_mem_access(addr, false);
+  timing_instr_end(LOAD);
+  timer_interrupt_check();
+}
+
+// the timer counts cycles and fires as soon as the interval is reached
+void test_timer_threshold() {
+  regs = calloc(NUM_REGISTERS, sizeof(uint32_t));
+  sram = tmpfile();
+  isr_to_prio = calloc(1, sizeof(uint8_t));
+  assign_isr_and_prio(INTERRUPT_TIMER, 0, 1);
+  regs[SP] = 0x80000100;
+  regs[PC] = 0x80000010;
+  write_file(sram, 0, 0x80000050);
+
+  timing_active = true;
+  latencies[TIMING_LOAD] = 2;
+  latencies[TIMING_SRAM] = 3;
+  interrupt_timer_interval = 10;
+  interrupt_timer_active = true;
+  cycles = 0;
+
+  run_load(0x80000020);
+  assert(elapsed_ticks() == 5 && cycles == 5);
+  assert(timer_cnt == 5 && interrupt_timer_active);
+  // entering the routine pushes the PC and reads the IVT in the SRAM
+  run_load(0x80000020);
+  assert(cycles == 10 + 2 * 3);
+  assert(timer_cnt == 0 && !interrupt_timer_active);
+  assert(stack_top == 0 && regs[PC] == 0x80000050);
+  fclose(sram);
+}
+
+int main() {
+  test_config();
+  test_invalid_configs();
+  test_instr_classes();
+  test_timer_threshold();
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "../include/assemble.h"
+#include "../include/reti.h"
+#include "../include/trace.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+void write_example_trace() {
+  trace_active = true;
+  trace_path = "/tmp/trace_test.trace";
+  regs = malloc(sizeof(uint32_t) * NUM_REGISTERS);
+  memset(regs, 0, sizeof(uint32_t) * NUM_REGISTERS);
+  init_trace();
+
+  trace_instr_begin(0, 0x70c00007);
+  regs[ACC] = 7;
+  regs[PC] = 1;
+  trace_instr_end();
+
+  trace_instr_begin(1, 0x80c00005);
+  trace_mem_write(0x80000005, 7);
+  regs[PC] = 2;
+  trace_instr_end();
+
+  trace_instr_begin(40, 0xf8000000);
+  regs[SP] = -3;
+  trace_instr_end();
+
+  fin_trace();
+  free(regs);
+}
+
+void test_trace_roundtrip(bool delta) {
+  trace_delta = delta;
+  write_example_trace();
+
+  Trace_Reader reader;
+  Trace_Record record;
+  assert(open_trace_reader(&reader, "/tmp/trace_test.trace"));
+  assert(reader.delta == delta);
+
+  assert(read_trace_record(&reader, &record));
+  assert(record.pc == 0);
+  assert(record.machine_instr == 0x70c00007);
+  assert(record.changed_regs == 1 << ACC);
+  assert(record.regs[ACC] == 7);
+  assert(record.num_mem_writes == 0);
+
+  assert(read_trace_record(&reader, &record));
+  assert(record.pc == 1);
+  assert(record.changed_regs == 0);
+  assert(record.num_mem_writes == 1);
+  assert(record.mem_writes[0].addr == 0x80000005);
+  assert(record.mem_writes[0].value == 7);
+
+  assert(read_trace_record(&reader, &record));
+  assert(record.pc == 40);
+  assert(record.changed_regs == 1 << SP);
+  assert(record.regs[SP] == (uint32_t)-3);
+  assert(record.regs[ACC] == 7);
+
+  assert(!read_trace_record(&reader, &record));
+  close_trace_reader(&reader);
+  remove("/tmp/trace_test.trace");
+}
+
+int main() {
+  test_trace_roundtrip(false);
+  test_trace_roundtrip(true);
+  return 0;
+}
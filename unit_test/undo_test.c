@@ -0,0 +1,136 @@
+#include "../include/interpr.h"
+#include "../include/interrupt.h"
+#include "../include/interrupt_controller.h"
+#include "../include/reti.h"
+#include "../include/timing.h"
+#include "../include/uart.h"
+#include "../include/undo.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void setup_machine() {
+  regs = calloc(NUM_REGISTERS, sizeof(uint32_t));
+  num_instrs_start_prgrm = 4;
+  eprom = calloc(num_instrs_start_prgrm, sizeof(uint32_t));
+  sram = tmpfile();
+  init_uart();
+  init_undo();
+}
+
+// one instruction that changes a register, the EPROM, the SRAM, the UART and
+// all counters, sending goes through undo_uart_send like in uart_send
+void test_instr_roundtrip() {
+  clear_undo_log();
+  regs[ACC] = 1;
+  regs[PC] = 0x80000002;
+  write_file(sram, 5, 7);
+  uint8_t old_status = uart[2];
+
+  undo_instr_begin();
+  regs[ACC] = 2;
+  regs[PC]++;
+  write_storage(3, 11);
+  write_storage(0x80000005, 8);
+  undo_uart_send();
+  uart[2] = 0;
+  all_send_data = strdup("42 ");
+  num_uart_outputs++;
+  num_isr_returns++;
+  cycles += 4;
+  num_executed_instrs++;
+  undo_instr_end();
+  assert(num_undoable_instrs() == 1);
+
+  assert(step_back());
+  assert(regs[ACC] == 1 && regs[PC] == 0x80000002);
+  assert(eprom[3] == 0);
+  assert(read_file(sram, 5) == 7);
+  assert(uart[2] == old_status && all_send_data == NULL);
+  assert(num_uart_outputs == 0 && num_isr_returns == 0);
+  assert(cycles == 0 && num_executed_instrs == 0);
+  assert(num_undoable_instrs() == 0);
+  assert(!step_back());
+}
+
+// every instruction takes two entries, so only the newest half of them fit
+void test_wrap_around() {
+  clear_undo_log();
+  uint32_t num_steps = UNDO_LOG_SIZE / 2 + 1000;
+  regs[ACC] = 0;
+  for (uint32_t i = 1; i <= num_steps; i++) {
+    undo_instr_begin();
+    regs[ACC] = i;
+    undo_instr_end();
+  }
+  assert(num_undoable_instrs() == UNDO_LOG_SIZE / 2);
+
+  uint32_t num_back = 0;
+  while (step_back()) {
+    num_back++;
+    assert(regs[ACC] == num_steps - num_back);
+  }
+  assert(num_back == UNDO_LOG_SIZE / 2);
+  assert(regs[ACC] == 1000);
+}
+
+void test_clear_undo_log() {
+  clear_undo_log();
+  undo_instr_begin();
+  regs[ACC] = 5;
+  undo_uart_send();
+  undo_instr_end();
+  assert(num_undoable_instrs() == 1);
+  clear_undo_log();
+  assert(num_undoable_instrs() == 0);
+  assert(!step_back());
+  assert(regs[ACC] == 5);
+}
+
+// the interrupt is triggered between two instructions and undone on its own
+void test_keypress_step() {
+  clear_undo_log();
+  isr_to_prio = calloc(2, sizeof(uint8_t));
+  assign_isr_and_prio(KEYPRESS, 1, 7);
+  keypress_interrupt_activatable = true;
+  write_file(sram, 1, 0x80000050);
+  write_file(sram, 0x100, 0);
+  regs[SP] = 0x80000100;
+  regs[PC] = 0x80000010;
+  regs[ACC] = 0;
+
+  undo_instr_begin();
+  regs[ACC] = 3;
+  regs[PC]++;
+  num_executed_instrs++;
+  undo_instr_end();
+
+  keypress_interrupt_trigger();
+  assert(keypress_interrupt_active);
+  assert(stack_top == 0 && isr_priority_stack[0] == 7);
+  assert(regs[PC] == 0x80000050 && regs[SP] == 0x800000ff);
+  assert(read_file(sram, 0x100) == 0x80000010);
+  assert(num_undoable_instrs() == 2);
+
+  assert(step_back());
+  assert(!keypress_interrupt_active);
+  assert(stack_top == -1 && isr_priority_stack[0] == 0);
+  assert(regs[PC] == 0x80000011 && regs[SP] == 0x80000100);
+  assert(read_file(sram, 0x100) == 0);
+  assert(regs[ACC] == 3 && num_executed_instrs == 1);
+
+  assert(step_back());
+  assert(regs[ACC] == 0 && regs[PC] == 0x80000010);
+  assert(num_executed_instrs == 0);
+}
+
+int main() {
+  setup_machine();
+  test_instr_roundtrip();
+  test_wrap_around();
+  test_clear_undo_log();
+  test_keypress_step();
+  fclose(sram);
+  return 0;
+}
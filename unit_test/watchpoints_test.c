@@ -0,0 +1,112 @@
+#include "../include/watchpoints.h"
+#include "../include/parse_args.h"
+#include "../include/reti.h"
+#include <assert.h>
+#include <string.h>
+
+#define SRAM_ADDR(idx) ((1u << 31) | (idx))
+
+static bool hit_after_access(uint32_t idx, bool is_write, uint32_t value) {
+  watchpoint_hit = false;
+  check_watchpoints(SRAM_ADDR(idx), is_write, value);
+  bool hit = watchpoint_hit;
+  watchpoint_hit = false;
+  return hit;
+}
+
+void test_parse_watchpoint() {
+  Watchpoint watchpoint;
+  assert(parse_watchpoint("wc 2147549180-2147549183", &watchpoint));
+  assert(watchpoint.kinds == (WATCH_WRITE | WATCH_CHANGE));
+  assert(watchpoint.from == 65532 && watchpoint.to == 65535);
+
+  assert(parse_watchpoint("r 2147483648", &watchpoint));
+  assert(watchpoint.kinds == WATCH_READ);
+  assert(watchpoint.from == 0 && watchpoint.to == 0);
+  assert(parse_watchpoint("rwc   2147483650", &watchpoint));
+  assert(watchpoint.kinds == (WATCH_READ | WATCH_WRITE | WATCH_CHANGE));
+}
+
+void test_parse_watchpoint_rejected() {
+  Watchpoint watchpoint;
+  // only SRAM addresses with bit 31 set can be watched
+  assert(!parse_watchpoint("r 42", &watchpoint));
+  assert(!parse_watchpoint("r 2147549184", &watchpoint));
+  assert(!parse_watchpoint("r 2147483660-2147483650", &watchpoint));
+  assert(!parse_watchpoint("r 2147483648-", &watchpoint));
+  assert(!parse_watchpoint("r 2147483648-42", &watchpoint));
+  assert(!parse_watchpoint("r -2147483648", &watchpoint));
+  assert(!parse_watchpoint("r 2147483648 1", &watchpoint));
+  assert(!parse_watchpoint("x 2147483648", &watchpoint));
+  assert(!parse_watchpoint(" 2147483648", &watchpoint));
+  assert(!parse_watchpoint("r", &watchpoint));
+}
+
+void test_range_across_pages() {
+  Watchpoint watchpoint = {page_size - 2, page_size + 1, WATCH_READ};
+  assert(toggle_watchpoint(&watchpoint));
+  assert(hit_after_access(page_size - 2, false, 0));
+  assert(hit_after_access(page_size + 1, false, 0));
+  assert(!hit_after_access(page_size - 3, false, 0));
+  assert(!hit_after_access(page_size + 2, false, 0));
+  // a read watchpoint doesn't stop at writes
+  assert(!hit_after_access(page_size, true, 42));
+  assert(is_watched(SRAM_ADDR(page_size)));
+  assert(!is_watched(page_size));
+
+  assert(toggle_watchpoint(&watchpoint));
+  assert(num_watchpoints == 0);
+  assert(!hit_after_access(page_size, false, 0));
+  assert(!is_watched(SRAM_ADDR(page_size)));
+}
+
+void test_write_and_change() {
+  write_file(sram, 10, 7);
+  Watchpoint change = {10, 10, WATCH_CHANGE};
+  assert(toggle_watchpoint(&change));
+  assert(!hit_after_access(10, true, 7));
+  assert(hit_after_access(10, true, 8));
+  assert(strncmp(watchpoint_hit_msg, "change of SRAM 10 from 7 to 8", 29) == 0);
+
+  Watchpoint write = {11, 11, WATCH_WRITE};
+  assert(toggle_watchpoint(&write));
+  write_file(sram, 11, 3);
+  assert(hit_after_access(11, true, 3));
+
+  // removing one watchpoint keeps the page of the other one watched
+  assert(toggle_watchpoint(&change));
+  assert(num_watchpoints == 1);
+  assert(!hit_after_access(10, true, 9));
+  assert(hit_after_access(11, true, 3));
+  assert(toggle_watchpoint(&write));
+  assert(num_watchpoints == 0);
+}
+
+void test_too_many_watchpoints() {
+  Watchpoint watchpoint = {0, 0, WATCH_READ};
+  for (uint8_t i = 0; i < MAX_WATCHPOINTS; i++) {
+    watchpoint.from = watchpoint.to = i;
+    assert(toggle_watchpoint(&watchpoint));
+  }
+  watchpoint.from = watchpoint.to = MAX_WATCHPOINTS;
+  assert(!toggle_watchpoint(&watchpoint));
+  for (uint8_t i = 0; i < MAX_WATCHPOINTS; i++) {
+    watchpoint.from = watchpoint.to = i;
+    assert(toggle_watchpoint(&watchpoint));
+  }
+  assert(num_watchpoints == 0);
+}
+
+int main() {
+  parse_args(4, (char *[]){"", "-f", "/tmp", "-"});
+  init_reti();
+  init_watchpoints();
+
+  test_parse_watchpoint();
+  test_parse_watchpoint_rejected();
+  test_range_across_pages();
+  test_write_and_change();
+  test_too_many_watchpoints();
+
+  return 0;
+}